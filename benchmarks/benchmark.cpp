@@ -1,3 +1,4 @@
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -7,8 +8,14 @@
 #include <limits>
 #include <vector>
 
+#include <unistd.h>
+
 #include "hashpack.h"
+#include "tabulation.h"
 #include "timers.hpp"
+#ifdef SHORTHASH_DISPATCH
+#include "dispatch.h"
+#endif
 
 using namespace std;
 
@@ -113,6 +120,104 @@ struct HashBench {
   HashValueType expected_;
 };
 
+// Same as HashBench, but hashes the whole array with one HashBatch call.
+template <typename T>
+struct BatchHashBench {
+  typedef typename T::Word Word;
+  typedef typename T::Randomness Randomness;
+
+  inline void Restart() const {
+    cache_flush(k_, sizeof(*k_));
+  }
+
+  inline Word Hash() const {
+    T::HashBatch(array_, out_, length_, k_);
+    Word sum = 0;
+    for (uint32_t x = 0; x < length_; ++x) {
+        sum += out_[x];
+    }
+    return sum;
+  }
+
+  BatchHashBench(const Word *const array, Word *const out,
+                 const uint32_t length, const Randomness *const k)
+    : array_(array), out_(out), length_(length), k_(k) {
+      expected_ = Hash();
+  }
+
+  const Word * const array_;
+  Word * const out_;
+  const uint32_t length_;
+  const Randomness * const k_;
+  Word expected_;
+};
+
+// Hashes the keys start + i stride with one HashRange call.
+template <typename T>
+struct RangeHashBench {
+  typedef typename T::Word Word;
+  typedef typename T::Randomness Randomness;
+
+  inline void Restart() const {
+    cache_flush(k_, sizeof(*k_));
+  }
+
+  inline Word Hash() const {
+    T::HashRange(start_, stride_, length_, out_, k_);
+    Word sum = 0;
+    for (uint32_t x = 0; x < length_; ++x) {
+        sum += out_[x];
+    }
+    return sum;
+  }
+
+  RangeHashBench(Word start, Word stride, Word *const out,
+                 const uint32_t length, const Randomness *const k)
+    : start_(start), stride_(stride), out_(out), length_(length), k_(k) {
+      expected_ = Hash();
+  }
+
+  const Word start_, stride_;
+  Word * const out_;
+  const uint32_t length_;
+  const Randomness * const k_;
+  Word expected_;
+};
+
+// Hashes every key of the array with HashMulti<K>, summing all K outputs.
+template <typename T, int K>
+struct MultiHashBench {
+  typedef typename T::Word Word;
+  typedef typename T::Randomness Randomness;
+
+  inline void Restart() const {
+    cache_flush(k_, sizeof(*k_));
+  }
+
+  inline Word Hash() const {
+    Word sum = 0;
+    Word out[K];
+    for (uint32_t x = 0; x < length_; ++x) {
+        T::template HashMulti<K>(array_[x], out, k_);
+        for (int i = 0; i < K; ++i) {
+            sum += out[i];
+        }
+    }
+    return sum;
+  }
+
+  MultiHashBench(const Word *const array, const uint32_t length,
+                 const Randomness *const k)
+    : array_(array), length_(length), k_(k) {
+      expected_ = Hash();
+  }
+
+  const Word * const array_;
+  const uint32_t length_;
+  const Randomness * const k_;
+  Word expected_;
+};
+
 static const int FIRST_FIELD_WIDTH = 20;
 static const int FIELD_WIDTH = 10;
 
@@ -124,39 +229,135 @@ static inline uint32_t intlog(uint32_t x) {
 
 template <typename T>
 inline timing_stat_t Bench(const typename T::Word *input, uint32_t length, int repeat) {
-    typename T::Randomness * randomness = new typename T::Randomness();
-    if(randomness == NULL) std::cerr << "Failure to allocate" << std::endl;
+    const auto holder = MakeRandomness<typename T::Randomness>();
+    typename T::Randomness * randomness = holder.get();
     T::InitRandomness(randomness);
 
     repeat = std::max(UINT32_C(1),repeat / intlog(length));
     HashBench<typename T::Randomness, typename T::Word, &T::HashFunction> demo(
         input, length, randomness);
     timing_stat_t answer =  BEST_TIME(demo, repeat, length);
-    delete randomness;
     return answer;
 }
 
+// Like Bench, but times HashBatch. Reports a wrong answer if the batch
+// disagrees with the scalar hash function.
+template <typename T>
+inline timing_stat_t BenchBatch(const typename T::Word *input, uint32_t length, int repeat) {
+    const auto holder = MakeRandomness<typename T::Randomness>();
+    typename T::Randomness * randomness = holder.get();
+    T::InitRandomness(randomness);
+
+    repeat = std::max(UINT32_C(1),repeat / intlog(length));
+    vector<typename T::Word> out(length);
+    BatchHashBench<T> demo(input, &out[0], length, randomness);
+    HashBench<typename T::Randomness, typename T::Word, &T::HashFunction>
+        scalar(input, length, randomness);
+    timing_stat_t answer =  BEST_TIME(demo, repeat, length);
+    answer.wrong_answer |= (scalar.expected_ != demo.expected_);
+    return answer;
+}
+
+// Like BenchBatch, but times HashRange over input, which must be the keys
+// input[0] + i stride.
+template <typename T>
+inline timing_stat_t BenchRange(const typename T::Word *input,
+                                typename T::Word stride, uint32_t length,
+                                int repeat) {
+    const auto holder = MakeRandomness<typename T::Randomness>();
+    typename T::Randomness * randomness = holder.get();
+    T::InitRandomness(randomness);
+
+    repeat = std::max(UINT32_C(1),repeat / intlog(length));
+    vector<typename T::Word> out(length);
+    RangeHashBench<T> demo(input[0], stride, &out[0], length, randomness);
+    HashBench<typename T::Randomness, typename T::Word, &T::HashFunction>
+        scalar(input, length, randomness);
+    timing_stat_t answer =  BEST_TIME(demo, repeat, length);
+    answer.wrong_answer |= (scalar.expected_ != demo.expected_);
+    return answer;
+}
+
+// Like Bench, but times HashMulti<K>: the cycles are per key, for all K
+// outputs.
+template <typename T, int K>
+inline timing_stat_t BenchMulti(const typename T::Word *input, uint32_t length,
+                                int repeat) {
+    const auto holder = MakeRandomness<typename T::Randomness>();
+    typename T::Randomness * randomness = holder.get();
+    T::InitRandomness(randomness);
+
+    repeat = std::max(UINT32_C(1),repeat / intlog(length));
+    MultiHashBench<T, K> demo(input, length, randomness);
+    return BEST_TIME(demo, repeat, length);
+}
+
+static void PrintTimings(const vector<timing_stat_t> &timings) {
+    for (const auto &t : timings) {
+        if (t.wrong_answer) {
+            cout << setw(FIELD_WIDTH) << "BUG";
+        } else {
+            cout << setw(FIELD_WIDTH) << fixed << setprecision(2) << t.avg_opc;
+        }
+    }
+    cout << endl;
+}
+
+// Each size gets three rows: one call per word, one HashBatch call for the
+// whole array, and how many times faster the batch is (below 1 it loses).
 template <typename Word, typename... Packs>
 void RunSizedBench(uint32_t length, int repeat) {
     vector<Word> input(length);
     for (auto &i : input) {
-        i = get64rand();
+        i = sizeof(Word) > sizeof(uint64_t) ? Word(get128rand())
+                                            : Word(get64rand());
     }
+    const vector<timing_stat_t> scalar{
+        (Bench<Packs>(&input[0], length, repeat))...};
+    const vector<timing_stat_t> batch{
+        (BenchBatch<Packs>(&input[0], length, repeat))...};
     cout << setw(FIRST_FIELD_WIDTH) << length;
-    for (const auto &t : {(Bench<Packs>(&input[0], length, repeat))...}) {
-        if (t.wrong_answer) {
-            cout << "BUG";
-        } else {
-            cout << setw(FIELD_WIDTH) << fixed << setprecision(2) << t.avg_opc;
-        }
+    PrintTimings(scalar);
+    cout << setw(FIRST_FIELD_WIDTH) << "batch";
+    PrintTimings(batch);
+    cout << setw(FIRST_FIELD_WIDTH) << "speedup";
+    for (size_t i = 0; i < scalar.size(); ++i) {
+        cout << setw(FIELD_WIDTH) << fixed << setprecision(2)
+             << scalar[i].avg_opc / batch[i].avg_opc;
+    }
+    cout << endl;
+}
+
+// Keys in arithmetic progression: one HashBatch call over the keys written
+// out, one HashRange call, and how many times faster the range is.
+template <typename Word, typename... Packs>
+void RunRangeBench(uint32_t length, Word stride, int repeat) {
+    vector<Word> input(length);
+    Word x = get64rand();
+    for (auto &i : input) {
+        i = x;
+        x += stride;
+    }
+    const vector<timing_stat_t> batch{
+        (BenchBatch<Packs>(&input[0], length, repeat))...};
+    const vector<timing_stat_t> range{
+        (BenchRange<Packs>(&input[0], stride, length, repeat))...};
+    cout << setw(FIRST_FIELD_WIDTH) << length;
+    PrintTimings(batch);
+    cout << setw(FIRST_FIELD_WIDTH) << "range";
+    PrintTimings(range);
+    cout << setw(FIRST_FIELD_WIDTH) << "speedup";
+    for (size_t i = 0; i < batch.size(); ++i) {
+        cout << setw(FIELD_WIDTH) << fixed << setprecision(2)
+             << batch[i].avg_opc / range[i].avg_opc;
     }
     cout << endl;
 }
 
 template <typename Word, typename... Packs>
 void printall(const vector<uint32_t> &lengths, int repeat) {
-    cout << numeric_limits<Word>::digits << " bit hash functions"
-         << endl;
+    // numeric_limits does not know uint128_t in strict C++11
+    cout << sizeof(Word) * CHAR_BIT << " bit hash functions" << endl;
     cout << setw(FIRST_FIELD_WIDTH) << "size \\ hash fn";
 
     for (const auto &s : {(Packs::NAME)...}) {
@@ -175,15 +376,116 @@ void printall(const vector<uint32_t> &lengths, int repeat) {
     }
 }
 
+#ifdef SHORTHASH_DISPATCH
+// batches go through the kernels of the level picked at run time
+template <typename Pack, typename... Packs>
+void basic(const vector<uint32_t> &lengths, int repeat) {
+  printall<typename Pack::Word, typename Dispatched<Pack>::type,
+           typename Dispatched<Packs>::type...>(lengths, repeat);
+}
+#else
 template <typename Pack, typename... Packs>
 void basic(const vector<uint32_t> &lengths, int repeat) {
   printall<typename Pack::Word, Pack, Packs...>(lengths, repeat);
 }
+#endif
 
 
 #include <sys/resource.h>
 
-int main() {
+// Simple tabulation for every character width, to pick the table footprint
+// (the "rand size" row) that fits next to the rest of the working set.
+void TabulationSweep(const vector<uint32_t> &sizes, int repeat) {
+    basic<TabulationPack<64, 8, 64>, TabulationPack<64, 11, 64>,
+          TabulationPack<64, 16, 64>, TabulationPack<64, 8, 32>,
+          TabulationPack<64, 11, 32>, TabulationPack<64, 16, 32>>(sizes,
+                                                                  repeat);
+    basic<TabulationPack<32, 8, 32>, TabulationPack<32, 11, 32>,
+          TabulationPack<32, 16, 32>>(sizes, repeat);
+}
+
+// HashRange against HashBatch for the arithmetic families, with the gaps of
+// the dense id ranges of htbenchmark's demofixed.
+template <typename Word, typename... Packs>
+void RangeSweep(const vector<uint32_t> &lengths, int repeat) {
+    for (const uint64_t stride : {UINT64_C(1), UINT64_C(1) << 16,
+                                  UINT64_C(1) << 31}) {
+        cout << numeric_limits<Word>::digits
+             << " bit hash functions, keys in steps of " << stride << endl;
+        cout << setw(FIRST_FIELD_WIDTH) << "size \\ hash fn";
+        for (const auto &s : {(Packs::NAME)...}) {
+            cout << setw(FIELD_WIDTH) << string(s).substr(0, FIELD_WIDTH - 1);
+        }
+        cout << endl;
+        for (const auto length : lengths) {
+            RunRangeBench<Word, Packs...>(length, Word(stride), repeat);
+        }
+    }
+}
+
+// One row of MultiSweep: HashMulti<K> of Multi, then of K separate Single
+// functions, and how many times faster Multi is.
+template <typename Multi, typename Single, int K>
+void RunMultiBench(const vector<typename Multi::Word> &input, int repeat) {
+    typedef MultiPack<Single, Multi::OUTPUTS> Separate;
+    const vector<timing_stat_t> timings{
+        BenchMulti<Multi, K>(&input[0], input.size(), repeat),
+        BenchMulti<Separate, K>(&input[0], input.size(), repeat)};
+    // the best runs: the gaps are a few cycles, below the run-to-run noise
+    cout << setw(FIRST_FIELD_WIDTH) << K;
+    for (const auto &t : timings) {
+        cout << setw(FIELD_WIDTH) << fixed << setprecision(2) << t.min_opc;
+    }
+    cout << setw(FIELD_WIDTH) << fixed << setprecision(2)
+         << timings[1].min_opc / timings[0].min_opc << endl;
+}
+
+// HashMulti<K> of a multi pack against K separate functions of the family,
+// for K from 1 to all the outputs.
+template <typename Multi, typename Single>
+void MultiSweep(uint32_t length, int repeat) {
+    typedef typename Multi::Word Word;
+    vector<Word> input(length);
+    for (auto &i : input) {
+        i = Word(get64rand());
+    }
+    cout << Multi::NAME << " against separate " << Single::NAME << ", "
+         << length << " keys" << endl;
+    cout << setw(FIRST_FIELD_WIDTH) << "outputs" << setw(FIELD_WIDTH)
+         << "multi" << setw(FIELD_WIDTH) << "separate" << setw(FIELD_WIDTH)
+         << "speedup" << endl;
+    RunMultiBench<Multi, Single, 1>(input, repeat);
+    RunMultiBench<Multi, Single, 2>(input, repeat);
+    RunMultiBench<Multi, Single, Multi::OUTPUTS / 2>(input, repeat);
+    RunMultiBench<Multi, Single, Multi::OUTPUTS>(input, repeat);
+}
+
+int main(int argc, char **argv) {
+    bool tabulation_sweep = false;
+    bool range_sweep = false;
+    bool multi_sweep = false;
+    bool huge_pages = false;
+    int c;
+    while ((c = getopt(argc, argv, "trmp")) != -1) {
+        if (c == 't') {
+            tabulation_sweep = true;
+        } else if (c == 'r') {
+            range_sweep = true;
+        } else if (c == 'm') {
+            multi_sweep = true;
+        } else if (c == 'p') {
+            huge_pages = true;
+        } else {
+            printf("Usage: %s [-t] [-r] [-m] [-p]\n", argv[0]);
+            printf("-t only sweeps the character widths of tabulation\n");
+            printf("-r only compares HashRange with HashBatch\n");
+            printf("-m only compares HashMulti<K> with K separate hash "
+                   "functions\n");
+            printf("-p also times the big tables on huge pages, against "
+                   "4 KB pages\n");
+            return -1;
+        }
+    }
     int repeat = 1000;
     if (global_rdtsc_overhead == UINT64_MAX) {
         RDTSC_SET_OVERHEAD(repeat);
@@ -194,26 +496,105 @@ int main() {
      printf("zobrist is 3-wise ind., linear is 2-wise ind., quadratic is 3-wise "
            "ind., cubic is 4-wise ind.\n");
     printf("Keys are flushed at the beginning of each run.\n");
+    printf("Each size is followed by a 'batch' row timing HashBatch and the "
+           "speedup of the batch over the scalar loop.\n");
+#ifdef SHORTHASH_DISPATCH
+    printf("Batch kernels dispatched at run time: %s\n",
+           ShorthashIsaName(ShorthashBestIsa()));
+#endif
     const vector<uint32_t> sizes{10, 20, 100, 1000, 10000, 100000,1000000};
+    if (tabulation_sweep) {
+        TabulationSweep(sizes, repeat);
+        return 0;
+    }
+    if (range_sweep) {
+        RangeSweep<uint64_t, MultiplyShift64Pack, UnivMultiplyShift64Pack,
+                   ThorupZhangCWLinear64Pack, ThorupZhangCWCubic64Pack,
+                   FasterCWLinear64Pack, FasterCWCubic64Pack>(sizes, repeat);
+        RangeSweep<uint32_t, MultiplyShift32Pack, ThorupZhangCWLinear32Pack,
+                   ThorupZhangCWCubic32Pack>(sizes, repeat);
+        return 0;
+    }
+    if (multi_sweep) {
+        MultiSweep<ClLinearMulti64Pack, ClLinear64Pack>(10000, repeat);
+        MultiSweep<ClFastQuadraticMulti64Pack, ClFastQuadratic64Pack>(10000,
+                                                                      repeat);
+        MultiSweep<ClLinearMulti32Pack, ClLinear32Pack>(10000, repeat);
+        MultiSweep<ClFastQuadraticMulti32Pack, ClFastQuadratic32Pack>(10000,
+                                                                      repeat);
+        MultiSweep<TabulationMultiPack<64, 8, 8>, TabulationPack<64, 8, 64>>(
+            10000, repeat);
+        MultiSweep<TabulationMultiPack<32, 8, 8>, TabulationPack<32, 8, 32>>(
+            10000, repeat);
+        return 0;
+    }
     // focus on tabulation + polynomial hashing
     basic<JavaSplit64Pack,Zobrist64Pack,WZobrist64Pack, ClCubic64Pack, 
           ThorupZhangCWCubic64Pack>(
         sizes, repeat);
 
+    // finalizer-style mixers: vpmullq (or 32x32 partial products) chains
+    basic<Murmur64Pack, Stafford64Pack, xxHash64Pack, Koloboke64Pack,
+          RandomKoloboke64Pack, RandomWeakKoloboke64Pack, JavaSplit64Pack,
+          Wyhash64Pack, FNV64Pack>(sizes, repeat);
+
+    // multiply-shift: 64x64->128 products from 32x32 partial products
+    basic<MultiplyShift64Pack, UnivMultiplyShift64Pack, MultiplyTwice64Pack,
+          MultiplyThrice64Pack>(sizes, repeat);
+
+    // tabulation: gathered table rows against the scalar loads
+    basic<Cyclic64Pack, Zobrist64Pack, ZobristFlat64Pack,
+          ZobristTranspose64Pack, WZobrist64Pack>(sizes, repeat);
+
+    // twisted, double and mixed tabulation against plain zobrist and
+    // Thorup-Zhang
+    basic<Zobrist64Pack, Twisted64Pack, DoubleTab64Pack, MixedTab64Pack<>,
+          ThorupZhang64Pack>(sizes, repeat);
+    basic<Zobrist32Pack, MixedTab32Pack<>, ThorupZhang32Pack>(sizes, repeat);
+
+    // with -p, the big tables (512 KB to 68 MB) on 4 KB pages, then on huge
+    // pages; everything else stays on the default 4 KB pages
+    if (huge_pages) {
+        const PagePolicy saved_policy = DefaultPagePolicy();
+        DefaultPagePolicy() = {PageSize::SMALL, false};
+        printf("4 KB pages:\n");
+        basic<WZobrist64Pack, ThorupZhang64Pack>(sizes, repeat);
+        basic<WZobrist32Pack, ThorupZhang32Pack>(sizes, repeat);
+        DefaultPagePolicy() = {PageSize::HUGE, true};
+        printf("huge pages:\n");
+        basic<WZobrist64Pack, ThorupZhang64Pack>(sizes, repeat);
+        basic<WZobrist32Pack, ThorupZhang32Pack>(sizes, repeat);
+        DefaultPagePolicy() = saved_policy;
+    }
+
     basic<Identity64Pack, Koloboke64Pack, BitMixing64Pack, ClBitMixing64Pack,
-          FNV64Pack, JavaSplit64Pack, Murmur64Pack, CRC32_64Pack, Cyclic64Pack, Zobrist64Pack,
-          WZobrist64Pack, ZobristTranspose64Pack, ThorupZhang64Pack,
+          FNV64Pack, JavaSplit64Pack, Murmur64Pack, CRC32_64Pack, CRCWide64Pack, Cyclic64Pack, Zobrist64Pack,
+          WZobrist64Pack, ZobristTranspose64Pack, MixedTab64Pack<>, ThorupZhang64Pack, CompactThorupZhang64Pack,
           MultiplyShift64Pack, ClLinear64Pack, ClQuadratic64Pack,
           ClFastQuadratic64Pack, ClCubic64Pack, ClQuartic64Pack,
           ThorupZhangCWLinear64Pack, ThorupZhangCWQuadratic64Pack,
-          ThorupZhangCWCubic64Pack, Linear64Pack, Toeplitz64Pack,
-          SplitPack<MultiplyShift64Pack, MultiplyShift64Pack, 64>, SipPack>(
+          ThorupZhangCWCubic64Pack, FasterCWLinear64Pack,
+          FasterCWQuadratic64Pack, FasterCWCubic64Pack, Linear64Pack,
+          Toeplitz64Pack,
+          SplitPack<MultiplyShift64Pack, MultiplyShift64Pack, 64>, SipPack,
+          Sip13Pack>(
         sizes, repeat);
 
-    basic<Murmur32Pack, CRC32Pack, Cyclic32Pack, Zobrist32Pack, WZobrist32Pack, ThorupZhang32Pack, MultiplyShift32Pack, ClLinear32Pack, ClFastQuadratic32Pack, CWQuad32Pack, ThorupZhangCWLinear32Pack, ThorupZhangCWQuadratic32Pack, ThorupZhangCWCubic32Pack>(sizes, repeat);
+    basic<Murmur32Pack, CRC32Pack, Cyclic32Pack, Zobrist32Pack, WZobrist32Pack, MixedTab32Pack<>, ThorupZhang32Pack, MultiplyShift32Pack, ClLinear32Pack, ClFastQuadratic32Pack, CWQuad32Pack, ThorupZhangCWLinear32Pack, ThorupZhangCWQuadratic32Pack, ThorupZhangCWCubic32Pack, HalfSip32Pack>(sizes, repeat);
+
+    // 128-bit keys (UUIDs, IPv6 addresses), 64-bit hashes
+    basic<ClLinear128Pack, ClQuadratic128Pack, PairMultiplyShift128Pack,
+          Zobrist128Pack, Sip128Pack>(sizes, repeat);
 
     printf("Large runs are beneficial to tabulation-based hashing because they "
            "amortize cache faults.\n");
+    printf("For tabulation, the speedup row compares gathers (vpgatherqq) to "
+           "scalar loads; the 2 MB wide zobrist table is bound by cache misses "
+           "either way.\n");
+    printf("The compiler already vectorizes the scalar loop of the mixers "
+           "(murmur, koloboke, splitmix, wyhash, FNV) when the hash is "
+           "inlined into a sum, so their batch rows pay an extra store; the "
+           "kernels help callers that cannot inline.\n");
     printf("The 32-bit CL hash functions generate a pair of 32-bit hash values.\n");
 
 }
@@ -52,7 +52,7 @@ struct Worker {
 
 template<typename... Packs>
 void demofixed(Reducer64 mod, const uint64_t howmany) {
-    srand(0);
+    seed64rand(0);
     const float repeat = 10000;
     std::vector<uint64_t>  keys;
     for(uint64_t i = 1; i <= howmany; ++i) {
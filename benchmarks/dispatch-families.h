@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+* The families whose batch kernels are compiled for several ISA levels and
+* picked at run time (see src/kernels.cpp and src/dispatch.cpp). Each entry
+* is X(Pack, Word, Randomness, batch kernel).
+*/
+#define SHORTHASH_DISPATCH_FAMILIES(X) \
+    X(SipPack, uint64_t, siphash_key_t, siphash24_batch) \
+    X(Sip13Pack, uint64_t, siphash_key_t, siphash13_batch) \
+    X(HalfSip32Pack, uint32_t, halfsiphash_key_t, halfsiphash24_batch) \
+    X(Identity64Pack, uint64_t, identity_t, identity64_batch) \
+    X(Cyclic64Pack, uint64_t, cyclic_t, cyclic_batch) \
+    X(Cyclic32Pack, uint32_t, cyclic32_t, cyclic32_batch) \
+    X(CRC32_64Pack, uint64_t, CRCRandomness, CRC32_64Batch) \
+    X(CRCWide64Pack, uint64_t, CRCWideRandomness, CRCWide64Batch) \
+    X(CRC32Pack, uint32_t, CRCRandomness, CRC32Batch) \
+    X(Murmur32Pack, uint32_t, murmur32_t, murmur32_batch) \
+    X(Murmur64Pack, uint64_t, murmur64_t, murmur64_batch) \
+    X(JavaSplit64Pack, uint64_t, javasplit64_t, javasplit64_batch) \
+    X(FNV64Pack, uint64_t, fnv64_t, fnv64_batch) \
+    X(Stafford64Pack, uint64_t, murmur64_t, murmur64_batch) \
+    X(xxHash64Pack, uint64_t, murmur64_t, murmur64_batch) \
+    X(Koloboke64Pack, uint64_t, koloboke_t, koloboke64_batch) \
+    X(RandomKoloboke64Pack, uint64_t, random_koloboke_t, random_koloboke64_batch) \
+    X(RandomWeakKoloboke64Pack, uint64_t, random_weak_koloboke_t, random_weak_koloboke64_batch) \
+    X(Zobrist64Pack, uint64_t, zobrist_t, zobrist_batch) \
+    X(WZobrist64Pack, uint64_t, wzobrist_t, wzobrist_batch) \
+    X(ZobristFlat64Pack, uint64_t, zobrist_flat_t, zobrist_flat_batch) \
+    X(ZobristTranspose64Pack, uint64_t, zobrist_flat_t, zobrist_flat_transpose_batch) \
+    X(BitMixing64Pack, uint64_t, bitmixing_t, bitmixing_batch) \
+    X(ClBitMixing64Pack, uint64_t, cl_bitmixing_t, cl_bitmixing_batch) \
+    X(ClLinear64Pack, uint64_t, cl_linear_t, cl_linear_batch) \
+    X(ClLinear32Pack, uint32_t, cl_linear_t, cl_linear32_batch) \
+    X(MultiplyShift64Pack, uint64_t, MultiplyShift64Randomness, MultiplyShift64Batch) \
+    X(UnivMultiplyShift64Pack, uint64_t, UnivMultiplyShift64Randomness, UnivMultiplyShift64Batch) \
+    X(MultiplyTwice64Pack, uint64_t, MultiplyTwice64Randomness, MultiplyTwice64Batch) \
+    X(MultiplyThrice64Pack, uint64_t, MultiplyThrice64Randomness, MultiplyThrice64Batch) \
+    X(ClQuadratic64Pack, uint64_t, cl_quadratic_t, cl_quadratic_batch) \
+    X(ClFastQuadratic64Pack, uint64_t, cl_fastquadratic_t, cl_fastquadratic_batch) \
+    X(Wyhash64Pack, uint64_t, uint64_t, wyhash_batch) \
+    X(ClFastQuadratic32Pack, uint32_t, cl_fastquadratic32_t, cl_fastquadratic32_batch) \
+    X(ClCubic64Pack, uint64_t, cl_cubic_t, cl_cubic_batch) \
+    X(ThorupZhangCWLinear64Pack, uint64_t, ThorupZhangCWLinear64_t, ThorupZhangCWLinear64Batch) \
+    X(ThorupZhangCWQuadratic64Pack, uint64_t, ThorupZhangCWQuadratic64_t, ThorupZhangCWQuadratic64Batch) \
+    X(ThorupZhangCWCubic64Pack, uint64_t, ThorupZhangCWCubic64_t, ThorupZhangCWCubic64Batch) \
+    X(FasterCWLinear64Pack, uint64_t, FasterCWLinear64_t, FasterCWLinear64Batch) \
+    X(FasterCWQuadratic64Pack, uint64_t, FasterCWQuadratic64_t, FasterCWQuadratic64Batch) \
+    X(FasterCWCubic64Pack, uint64_t, FasterCWCubic64_t, FasterCWCubic64Batch) \
+    X(ClQuartic64Pack, uint64_t, cl_quartic_t, cl_quartic_batch) \
+    X(Zobrist32Pack, uint32_t, zobrist32_t, zobrist32_batch) \
+    X(WZobrist32Pack, uint32_t, wzobrist32_t, wzobrist32_batch) \
+    X(ThorupZhang32Pack, uint32_t, thorupzhang32_t, thorupzhang32_batch) \
+    X(MultiplyShift32Pack, uint32_t, MultiplyShift32Randomness, MultiplyShift32Batch) \
+    X(CWQuad32Pack, uint32_t, CWRandomQuad32, CWQuad32Batch) \
+    X(ThorupZhangCWLinear32Pack, uint32_t, ThorupZhangCWLinear32_t, ThorupZhangCWLinear32Batch) \
+    X(ThorupZhangCWQuadratic32Pack, uint32_t, ThorupZhangCWQuadratic32_t, ThorupZhangCWQuadratic32Batch) \
+    X(ThorupZhangCWCubic32Pack, uint32_t, ThorupZhangCWCubic32_t, ThorupZhangCWCubic32Batch) \
+    X(Linear64Pack, uint64_t, Linear64Randomness, Linear64Batch) \
+    X(Toeplitz64Pack, uint64_t, Toeplitz64Randomness, Toeplitz64Batch)
+
+enum {
+#define SHORTHASH_KERNEL_INDEX(pack, word, randomness, batch) \
+    SHORTHASH_KERNEL_##pack,
+    SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_KERNEL_INDEX)
+#undef SHORTHASH_KERNEL_INDEX
+    SHORTHASH_NBR_KERNELS
+};
+
+// batch kernels with their types erased, so that every level fits one table
+typedef void (*ShorthashBatchKernel)(const void *in, void *out, size_t n,
+                                     const void *randomness);
+
+enum class ShorthashIsa { X86_64_V2, X86_64_V3, X86_64_V4 };
+
+// the kernels compiled for one level
+const ShorthashBatchKernel *ShorthashKernelsFor(ShorthashIsa isa);
+
+// the best level this CPU supports; SHORTHASH_ISA=x86-64-v2 (or v3) in the
+// environment picks a lower one
+ShorthashIsa ShorthashBestIsa();
+
+const char *ShorthashIsaName(ShorthashIsa isa);
+
+// the kernels of ShorthashBestIsa(), chosen on the first call
+const ShorthashBatchKernel *ShorthashKernels();
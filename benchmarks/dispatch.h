@@ -0,0 +1,48 @@
+#pragma once
+
+#include "dispatch-families.h"
+#include "hashpack.h"
+
+/**
+* Packs whose HashBatch goes through the kernels picked at run time (link
+* libshorthash.a). The scalar HashFunction is unchanged: it stays inline and
+* is compiled for the program's own -march.
+*/
+
+// index of Pack in the kernel tables, or -1 if it has no dispatched kernel
+template <typename Pack>
+struct DispatchIndex {
+    static constexpr int value = -1;
+};
+
+#define SHORTHASH_DISPATCH_INDEX(pack, word, randomness, batch) \
+    template <>                                                 \
+    struct DispatchIndex<pack> {                                \
+        static constexpr int value = SHORTHASH_KERNEL_##pack;   \
+    };
+SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_DISPATCH_INDEX)
+#undef SHORTHASH_DISPATCH_INDEX
+
+template <typename Pack>
+struct DispatchedPack : public Pack {
+    static_assert(DispatchIndex<Pack>::value >= 0,
+                  "no dispatched kernel for this pack");
+    typedef typename Pack::Word Word;
+    typedef typename Pack::Randomness Randomness;
+
+    static inline void HashBatch(const Word *in, Word *out, size_t n,
+                                 const Randomness *r) {
+        ShorthashKernels()[DispatchIndex<Pack>::value](in, out, n, r);
+    }
+};
+
+// DispatchedPack<Pack> where there is a kernel to dispatch, else Pack itself
+template <typename Pack, bool = (DispatchIndex<Pack>::value >= 0)>
+struct Dispatched {
+    typedef DispatchedPack<Pack> type;
+};
+
+template <typename Pack>
+struct Dispatched<Pack, false> {
+    typedef Pack type;
+};
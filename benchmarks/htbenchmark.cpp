@@ -121,12 +121,12 @@ struct BasicWorker {
     static inline void Stop() {}
 };
 
-#define MYHASHER CRC32_64Pack, Murmur64Pack, Stafford64Pack, xxHash64Pack, ClBitMixing64Pack, BitMixing64Pack, Koloboke64Pack, Cyclic64Pack, Zobrist64Pack,  WZobrist64Pack, ClCubic64Pack , ThorupZhangCWCubic64Pack, MultiplyShift64Pack, ClLinear64Pack, Linear64Pack, Toeplitz64Pack, SplitPack<MultiplyShift64Pack, MultiplyShift64Pack,64>
+#define MYHASHER CRC32_64Pack, Murmur64Pack, Stafford64Pack, xxHash64Pack, ClBitMixing64Pack, BitMixing64Pack, Koloboke64Pack, Cyclic64Pack, Zobrist64Pack,  WZobrist64Pack, Twisted64Pack, DoubleTab64Pack, MixedTab64Pack<>, CompactThorupZhang64Pack, ClCubic64Pack , ThorupZhangCWCubic64Pack, MultiplyShift64Pack, ClLinear64Pack, Linear64Pack, Toeplitz64Pack, SplitPack<MultiplyShift64Pack, MultiplyShift64Pack,64>
 
 template <bool robinhood = true>
 void demorandom(const uint64_t howmany, const float loadfactor,
                 const float repeat, const size_t howmanyqueries) {
-    srand(0);
+    seed64rand(0);
     if(robinhood) std::cout << " Robin Hood activated " << std::endl;
     std::vector<std::vector<uint64_t> > allkeys;
     for(size_t r = 0; r < repeat; ++r)  {
@@ -154,7 +154,7 @@ void demorandom(const uint64_t howmany, const float loadfactor,
 
 template <bool robinhood = true>
 void demofixed(const uint64_t howmany, const uint32_t gap, const float loadfactor, const float repeat, const size_t howmanyqueries) {
-    srand(0);
+    seed64rand(0);
     if(robinhood) std::cout << " Robin Hood activated " << std::endl;
     std::vector<std::vector<uint64_t> > allkeys;
     for(size_t r = 0; r < repeat; ++r)  {
@@ -180,6 +180,79 @@ void demofixed(const uint64_t howmany, const uint32_t gap, const float loadfacto
 
 }
 
+// Pack used as a hasher through a shared_ptr to its randomness, the way
+// every GenericPack used to be, to compare with embedded randomness.
+template <typename Pack>
+struct SharedPtrPack {
+    static constexpr auto NAME = Pack::NAME;
+    typedef typename Pack::Word Word;
+    typedef typename Pack::Randomness Randomness;
+
+    SharedPtrPack() : myr(new Randomness()) { Pack::InitRandomness(myr.get()); }
+
+    __attribute__((always_inline)) inline size_t operator()(Word x) const {
+        return Pack::HashFunction(x, myr.get());
+    }
+
+    std::shared_ptr<Randomness> myr;
+};
+
+// Query cycles when every key is queried, to compare ways of holding the
+// same hash function.
+template <typename... Packs>
+void queryall(std::vector<std::vector<uint64_t> > &allkeys,
+              const float loadfactor, const float repeat, const char *title) {
+    std::cout << title << std::endl;
+    ForEachT<Packs...>::template Go<BasicWorker<true> >(
+        allkeys, loadfactor, repeat, allkeys[0].size());
+}
+
+std::vector<std::vector<uint64_t> > randomkeys(const uint64_t howmany,
+                                               const float loadfactor,
+                                               const float repeat) {
+    seed64rand(0);
+    std::vector<std::vector<uint64_t> > allkeys;
+    for(size_t r = 0; r < repeat; ++r)  {
+      std::vector<uint64_t>  keys;
+      for(uint64_t i = 1; i <= howmany; ++i) {
+        uint64_t newkey = get64rand();
+        while(newkey == EMPTY) newkey = get64rand();
+        keys.push_back(newkey);
+      }
+      allkeys.push_back(keys);
+    }
+    std::cout << "querying all " << howmany << " random 64-bit keys, load factor = " << loadfactor << std::endl;
+    return allkeys;
+}
+
+// small randomness embedded in the hasher (the default) or behind a
+// shared_ptr
+void demostorage(const uint64_t howmany, const float loadfactor,
+                 const float repeat) {
+    std::vector<std::vector<uint64_t> > allkeys = randomkeys(howmany, loadfactor, repeat);
+    queryall<Murmur64Pack, Koloboke64Pack, MultiplyShift64Pack, ClLinear64Pack,
+             ClCubic64Pack>(allkeys, loadfactor, repeat,
+                            "randomness embedded in the hasher:");
+    queryall<SharedPtrPack<Murmur64Pack>, SharedPtrPack<Koloboke64Pack>,
+             SharedPtrPack<MultiplyShift64Pack>, SharedPtrPack<ClLinear64Pack>,
+             SharedPtrPack<ClCubic64Pack> >(allkeys, loadfactor, repeat,
+                                            "randomness behind a shared_ptr:");
+    std::cout << std::endl;
+}
+
+// fixed constants loaded from the randomness or compiled in as immediates
+void democonstants(const uint64_t howmany, const float loadfactor,
+                   const float repeat) {
+    std::vector<std::vector<uint64_t> > allkeys = randomkeys(howmany, loadfactor, repeat);
+    queryall<BitMixing64Pack, ClBitMixing64Pack, Murmur64Pack, Koloboke64Pack,
+             Wyhash64Pack>(allkeys, loadfactor, repeat,
+                           "constants loaded from the randomness:");
+    queryall<BitMixing64ConstPack<>, ClBitMixing64ConstPack<>,
+             Murmur64ConstPack<>, Koloboke64ConstPack<>, Wyhash64ConstPack<> >(
+        allkeys, loadfactor, repeat, "constants as template arguments:");
+    std::cout << std::endl;
+}
+
 uint64_t reversebits(uint64_t v) {
   uint64_t r = v; // r will be reversed bits of v; first get LSB of v
   int s = sizeof(v) * CHAR_BIT - 1; // extra shift needed at end
@@ -194,7 +267,7 @@ uint64_t reversebits(uint64_t v) {
 
 template <bool robinhood = true>
 void demofillfromtop(const uint64_t howmany, const float loadfactor,  uint32_t repeat,const size_t howmanyqueries) {
-    srand(0);
+    seed64rand(0);
     if(robinhood) std::cout << " Robin Hood activated " << std::endl;
     std::vector<std::vector<uint64_t> > allkeys;
     for(size_t r = 0; r < repeat; ++r)  {
@@ -260,4 +333,11 @@ int main() {
     for(int size = minsize; size <= maxsize; size*= 2)
       demorandom<false>(size, loadfactor,  repeat, howmanyqueries);
 
+    std::cout << "=======" << std::endl;
+
+    for(int size = minsize; size <= maxsize; size*= 2)
+      demostorage(size, loadfactor, repeat);
+    for(int size = minsize; size <= maxsize; size*= 2)
+      democonstants(size, loadfactor, repeat);
+
 }
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+
+/**
+* Where the Randomness of a pack is allocated. The big tabulation tables
+* (wide zobrist, Thorup-Zhang) span hundreds of 4 KB pages, so every random
+* lookup is also a TLB miss; backing them with 2 MB or 1 GB pages removes
+* most of those misses.
+*
+* HUGE tries reserved 2 MB pages (MAP_HUGETLB), then transparent huge pages
+* (madvise(MADV_HUGEPAGE)) on a 2 MB aligned mapping; HUGE_1GB tries 1 GB
+* pages first. SMALL maps 4 KB pages and opts them out of transparent huge
+* pages (madvise(MADV_NOHUGEPAGE)), so that with THP set to "always" the
+* comparison still sees small pages. Objects smaller than
+* HUGE_PAGE_MIN_BYTES always come from operator new, since a huge page would
+* be mostly wasted on them. With prefault, every page is touched at
+* allocation time so that the first lookups do not pay for page faults.
+*
+* The default policy is SMALL: huge pages are opt-in, e.g. with benchmark -p.
+*/
+enum class PageSize { SMALL, HUGE, HUGE_1GB };
+
+struct PagePolicy {
+    PageSize pages;
+    bool prefault;
+};
+
+static constexpr size_t HUGE_PAGE_MIN_BYTES = size_t(1) << 18;
+static constexpr size_t HUGE_PAGE_BYTES = size_t(1) << 21;
+
+// policy used by the pack constructors and the benchmarks
+inline PagePolicy &DefaultPagePolicy() {
+    static PagePolicy policy = {PageSize::SMALL, false};
+    return policy;
+}
+
+static inline size_t RoundUp(size_t x, size_t to) {
+    return (x + to - 1) / to * to;
+}
+
+// Maps at least size bytes following policy; *mapped receives the length to
+// give back to munmap. Returns NULL if no huge-page mapping could be made.
+inline void *MapHugePages(size_t size, const PagePolicy &policy,
+                          size_t *mapped) {
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    const int populate = policy.prefault ? MAP_POPULATE : 0;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    if (policy.pages == PageSize::HUGE_1GB) {
+        const size_t length = RoundUp(size, size_t(1) << 30);
+        void *p = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       flags | populate | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT),
+                       -1, 0);
+        if (p != MAP_FAILED) {
+            *mapped = length;
+            return p;
+        }
+    }
+    {
+        const size_t length = RoundUp(size, HUGE_PAGE_BYTES);
+        void *p = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                       flags | populate | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT),
+                       -1, 0);
+        if (p != MAP_FAILED) {
+            *mapped = length;
+            return p;
+        }
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    // over-allocate by one huge page, then trim to a 2 MB aligned range
+    const size_t length = RoundUp(size, HUGE_PAGE_BYTES);
+    void *raw = mmap(NULL, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE,
+                     flags, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = RoundUp(start, HUGE_PAGE_BYTES);
+    if (aligned > start) munmap(raw, aligned - start);
+    const size_t tail = start + length + HUGE_PAGE_BYTES - (aligned + length);
+    if (tail > 0) munmap(reinterpret_cast<void *>(aligned + length), tail);
+    void *p = reinterpret_cast<void *>(aligned);
+    madvise(p, length, MADV_HUGEPAGE);
+    if (policy.prefault) {
+        // writes, since reads would all map the shared zero page; one per
+        // 4 KB page in case the kernel falls back to small pages
+        volatile char *bytes = static_cast<volatile char *>(p);
+        for (size_t i = 0; i < length; i += 4096) bytes[i] = 0;
+    }
+    *mapped = length;
+    return p;
+#else
+    (void)size;
+    (void)mapped;
+    return NULL;
+#endif
+}
+
+// Maps at least size bytes on 4 KB pages, kept out of transparent huge pages;
+// *mapped receives the length to give back to munmap. Returns NULL if the
+// mapping fails.
+inline void *MapSmallPages(size_t size, const PagePolicy &policy,
+                           size_t *mapped) {
+    const size_t length = RoundUp(size, 4096);
+    void *p = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+#ifdef MADV_NOHUGEPAGE
+    madvise(p, length, MADV_NOHUGEPAGE);
+#endif
+    if (policy.prefault) {
+        // after the madvise, so that the faults map small pages
+        volatile char *bytes = static_cast<volatile char *>(p);
+        for (size_t i = 0; i < length; i += 4096) bytes[i] = 0;
+    }
+    *mapped = length;
+    return p;
+}
+
+// Allocates a Randomness following policy. The memory is zeroed either way
+// and released (munmap or delete) when the last shared_ptr goes away.
+template <typename Randomness>
+std::shared_ptr<Randomness>
+MakeRandomness(const PagePolicy &policy = DefaultPagePolicy()) {
+    size_t mapped = 0;
+    void *p = NULL;
+    if (sizeof(Randomness) >= HUGE_PAGE_MIN_BYTES) {
+        p = policy.pages == PageSize::SMALL
+                ? MapSmallPages(sizeof(Randomness), policy, &mapped)
+                : MapHugePages(sizeof(Randomness), policy, &mapped);
+    }
+    if (p == NULL) return std::shared_ptr<Randomness>(new Randomness());
+    // anonymous mappings are already zero, so default-initialize only
+    Randomness *r = new (p) Randomness;
+    return std::shared_ptr<Randomness>(r, [mapped](Randomness *q) {
+        q->~Randomness();
+        munmap(q, mapped);
+    });
+}
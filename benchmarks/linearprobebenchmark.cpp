@@ -79,7 +79,7 @@ struct Worker {
 };
 
 void demorandom(const uint64_t howmany, const float loadfactor, const int repeat) {
-    srand(0);
+    seed64rand(0);
     std::vector<uint64_t>  keys;
     for(uint64_t i = 1; i <= howmany; ++i) {
         keys.push_back(get64rand());
@@ -98,7 +98,7 @@ void demorandom(const uint64_t howmany, const float loadfactor, const int repeat
 }
 
 void demofixed(const uint64_t howmany, const float loadfactor, const int repeat) {
-    srand(0);
+    seed64rand(0);
     std::vector<uint64_t>  keys;
     for(uint64_t i = 1; i <= howmany; ++i) {
         keys.push_back(i +  UINT64_C(5555555555));
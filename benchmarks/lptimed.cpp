@@ -137,7 +137,7 @@ HashSet<uint64_t, WZobrist64Pack>
 */
 void demorandom(const uint64_t howmany, const float repeat,
                 const size_t howmanyqueries) {
-    srand(0);
+    seed64rand(0);
     std::vector<uint64_t> keys;
     for (uint64_t i = 0; i < howmany; ++i) {
         keys.push_back(get64rand());
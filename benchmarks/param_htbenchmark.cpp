@@ -114,10 +114,10 @@ enum {GEOMETRIC=0, FROMTOP=1, RANDOM=2, GRAYCODE = 3};
 const char*models[] = {"geometric","fromtop","random", "graycode"};
 
 
-const char* hashfamilies[] = {"murmur","koloboke","zobrist", "wide-zobrist", "tztabulated", "cllinear", "clquadratic", "clcubic", "cwlinear", "cwquadratic", "cwcubic","multiplyshift", "cyclic", "fnv", "identity"};
+const char* hashfamilies[] = {"murmur","koloboke","zobrist", "wide-zobrist", "tztabulated", "cllinear", "clquadratic", "clcubic", "cwlinear", "cwquadratic", "cwcubic","multiplyshift", "cyclic", "fnv", "identity", "reversedoddmultiply", "randomkoloboke", "mixedtab", "twisted", "doubletab", "compacttz"};
 
 void printusage(const char * name) {
-    printf("Usage: %s -l [maxloadfactor:0-1] -s [size:>0] -m [model:0-%d] -H [hashfamily:0-%d]\n",name,(int)(sizeof(models)/sizeof(models[0]))-1,(int)(sizeof(hashfamilies)/sizeof(hashfamilies[0]))-1);
+    printf("Usage: %s -l [maxloadfactor:0-1] -s [size:>0] -m [model:0-%d] -H [hashfamily:0-%d] -r [seed]\n",name,(int)(sizeof(models)/sizeof(models[0]))-1,(int)(sizeof(hashfamilies)/sizeof(hashfamilies[0]))-1);
     printf("\n");
     for(int i = 0; i < (int)(sizeof(models)/sizeof(models[0])); ++i) {
         printf("model %d is %s \n",i,models[i]);
@@ -134,21 +134,19 @@ int main(int argc, char **argv) {
     int size = -1;
     int model = -1;
     int hasher = -1;
-    int seed = 0;
+    unsigned long long seed = 0;
     struct timespec currenttime;
     if( clock_gettime( CLOCK_REALTIME, &currenttime) == -1 ) {
       seed = time(NULL);
     } else {
       seed = currenttime.tv_nsec;
     }
-    printf("# random seed = %d \n",seed);
-    srand (seed);
     int c;
     if(argc == 1) {
         printusage(argv[0]);
         return -1;
     }
-    while ((c = getopt(argc, argv, "hl:s:m:H:")) != -1) switch (c) {
+    while ((c = getopt(argc, argv, "hl:s:m:H:r:")) != -1) switch (c) {
         case 'l':
             loadfactor = atof(optarg);
             printf("# using max. load factor of %f \n",loadfactor);
@@ -160,6 +158,9 @@ int main(int argc, char **argv) {
         case 'H':
             hasher = atoi(optarg);
             break;
+        case 'r':
+            seed = strtoull(optarg, NULL, 10);
+            break;
         case 'm':
             model = atoi(optarg);
             printf("# using model %s \n",models[model]);
@@ -187,6 +188,8 @@ int main(int argc, char **argv) {
         printusage(argv[0]);
         return -1;
     }
+    printf("# random seed = %llu \n",seed);
+    seed64rand(seed);
     std::vector<uint64_t>  keys;
     size_t howmany = size;
 
@@ -205,7 +208,7 @@ int main(int argc, char **argv) {
         for(uint64_t i = 0; i < howmany; ++i) {
             uint64_t val = i + init;
             val = val ^ ( val >> 1);
-            keys.push_back(i + init);
+            keys.push_back(val);
         }
     } else {
         for(uint64_t i = 0; i < howmany; ++i) {
@@ -268,6 +271,18 @@ int main(int argc, char **argv) {
     case 16:
         BasicWorker<robinhood>::Go<RandomKoloboke64Pack>(keys,loadfactor);
         break;
+    case 17:
+        BasicWorker<robinhood>::Go<MixedTab64Pack<> >(keys,loadfactor);
+        break;
+    case 18:
+        BasicWorker<robinhood>::Go<Twisted64Pack>(keys,loadfactor);
+        break;
+    case 19:
+        BasicWorker<robinhood>::Go<DoubleTab64Pack>(keys,loadfactor);
+        break;
+    case 20:
+        BasicWorker<robinhood>::Go<CompactThorupZhang64Pack>(keys,loadfactor);
+        break;
 
     default:
         printf("unrecognized hasher index %d \n", hasher);
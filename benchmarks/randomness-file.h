@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+* Randomness files: the raw bytes of a pack's Randomness behind a small
+* versioned header, so that tables built once (from one seed) can be shared.
+* The payload starts on a page boundary, so MapRandomness maps it read-only
+* in place: startup is a page-table setup, and every process mapping the
+* same file shares one copy of the tables through the page cache.
+*
+* A file is only accepted by the same pack (name and size) on a machine
+* with the same byte order. The mapped randomness is read-only: hash with it
+* through the static Pack::HashFunction / Pack::HashBatch, or build a hasher
+* over it with the constructor of GenericPack that takes the randomness.
+*/
+
+static constexpr char RANDOMNESS_FILE_MAGIC[8] = {'S', 'H', 'R', 'A',
+                                                  'N', 'D', '\0', '\0'};
+static constexpr uint32_t RANDOMNESS_FILE_VERSION = 1;
+static constexpr size_t RANDOMNESS_FILE_PAYLOAD_OFFSET = 4096;
+
+struct RandomnessFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t payload_offset;
+    uint64_t byte_order;  // 0x0102030405060708 as written by the saver
+    uint64_t payload_size;
+    char name[64];        // Pack::NAME
+};
+
+template <typename Pack>
+static inline void FillRandomnessFileHeader(RandomnessFileHeader *h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, RANDOMNESS_FILE_MAGIC, sizeof(h->magic));
+    h->version = RANDOMNESS_FILE_VERSION;
+    h->payload_offset = RANDOMNESS_FILE_PAYLOAD_OFFSET;
+    h->byte_order = UINT64_C(0x0102030405060708);
+    h->payload_size = sizeof(typename Pack::Randomness);
+    strncpy(h->name, Pack::NAME, sizeof(h->name) - 1);
+}
+
+// Writes r to path. Returns false if the file could not be written.
+template <typename Pack>
+bool SaveRandomness(const char *path, const typename Pack::Randomness *r) {
+    static_assert(std::is_trivially_copyable<typename Pack::Randomness>::value,
+                  "randomness is saved as raw bytes");
+    RandomnessFileHeader h;
+    FillRandomnessFileHeader<Pack>(&h);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) return false;
+    static const char padding[RANDOMNESS_FILE_PAYLOAD_OFFSET] = {0};
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(padding, RANDOMNESS_FILE_PAYLOAD_OFFSET - sizeof(h), 1,
+                     f) == 1 &&
+              fwrite(r, sizeof(*r), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
+
+// Maps the randomness saved in path read-only. Returns NULL if the file is
+// missing, truncated, or was written by another pack, version or byte order.
+// The mapping lives as long as the returned pointer (and its copies), which
+// can be handed to the constructor of a table pack, e.g.
+// Zobrist64Pack hasher(MapRandomness<Zobrist64Pack>(path)).
+template <typename Pack>
+std::shared_ptr<const typename Pack::Randomness>
+MapRandomness(const char *path) {
+    typedef typename Pack::Randomness Randomness;
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    const size_t length = RANDOMNESS_FILE_PAYLOAD_OFFSET + sizeof(Randomness);
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) != length) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    RandomnessFileHeader expected;
+    FillRandomnessFileHeader<Pack>(&expected);
+    if (memcmp(p, &expected, sizeof(expected)) != 0) {
+        munmap(p, length);
+        return NULL;
+    }
+    const char *payload =
+        static_cast<const char *>(p) + RANDOMNESS_FILE_PAYLOAD_OFFSET;
+    return std::shared_ptr<const Randomness>(
+        reinterpret_cast<const Randomness *>(payload),
+        [p, length](const Randomness *) { munmap(p, length); });
+}
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <type_traits>
+
+#include "hashpack.h"
+
+/**
+* Simple tabulation over KEY_BITS-bit keys cut into CHAR_BITS-bit characters,
+* with OUT_BITS-bit table entries. The table footprint is the knob:
+* 8-bit characters with 64-bit entries (zobrist) take 16 KB, 11-bit ones
+* 84 KB and 16-bit ones (wzobrist) 2 MB; 32-bit entries halve each of these
+* when 32 hash bits are enough.
+*
+* The tables are stored one after the other, the last one only as large as
+* the bits left for the last character. With 8- and 16-bit characters the
+* layout is that of zobrist_t, wzobrist_t, zobrist32_t and wzobrist32_t.
+*/
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+struct TabulationRandomness {
+    static_assert(KEY_BITS == 32 || KEY_BITS == 64, "32- or 64-bit keys");
+    static_assert(CHAR_BITS == 8 || CHAR_BITS == 11 || CHAR_BITS == 16,
+                  "8-, 11- or 16-bit characters");
+    static_assert(OUT_BITS == 32 || OUT_BITS == 64, "32- or 64-bit entries");
+    static_assert(OUT_BITS <= KEY_BITS, "entries are not wider than keys");
+
+    typedef typename std::conditional<KEY_BITS == 64, uint64_t,
+                                      uint32_t>::type Key;
+    typedef typename std::conditional<OUT_BITS == 64, uint64_t,
+                                      uint32_t>::type Entry;
+
+    static constexpr int CHARACTER_BITS = CHAR_BITS;
+    static constexpr int CHARS = (KEY_BITS + CHAR_BITS - 1) / CHAR_BITS;
+    static constexpr int LAST_CHAR_BITS = KEY_BITS - (CHARS - 1) * CHAR_BITS;
+    static constexpr size_t TABLE_SIZE = size_t(1) << CHAR_BITS;
+    static constexpr size_t ENTRIES =
+        (CHARS - 1) * TABLE_SIZE + (size_t(1) << LAST_CHAR_BITS);
+
+    Entry hashtab[ENTRIES];
+};
+
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+void TabulationInit(TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> *r) {
+    typedef TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> R;
+    if (OUT_BITS == 64) {
+        fill64rand(reinterpret_cast<uint64_t *>(r->hashtab), R::ENTRIES);
+    } else {
+        fill32rand(reinterpret_cast<uint32_t *>(r->hashtab), R::ENTRIES);
+    }
+}
+
+// Character J of x. Whole bytes and shorts are read from memory, as in
+// zobrist; otherwise the shift leaves at most LAST_CHAR_BITS bits for the
+// last character.
+template <typename R, int J, int WIDTH = R::CHARACTER_BITS>
+struct TabulationCharacter {
+    __attribute__((always_inline)) static inline size_t
+    Get(const typename R::Key &x) {
+        return (x >> (J * WIDTH)) & (R::TABLE_SIZE - 1);
+    }
+};
+
+template <typename R, int J>
+struct TabulationCharacter<R, J, 8> {
+    __attribute__((always_inline)) static inline size_t
+    Get(const typename R::Key &x) {
+        return ((const unsigned char *)&x)[J];
+    }
+};
+
+template <typename R, int J>
+struct TabulationCharacter<R, J, 16> {
+    __attribute__((always_inline)) static inline size_t
+    Get(const typename R::Key &x) {
+        return ((const uint16_t *)&x)[J];
+    }
+};
+
+// xor of the entries of characters J and up, unrolled at compile time
+template <typename R, int J = 0, bool END = (J == R::CHARS)>
+struct TabulationChars {
+    __attribute__((always_inline)) static inline typename R::Entry
+    Hash(const typename R::Key &x, const typename R::Entry *t) {
+        return t[J * R::TABLE_SIZE + TabulationCharacter<R, J>::Get(x)] ^
+               TabulationChars<R, J + 1>::Hash(x, t);
+    }
+};
+
+template <typename R, int J>
+struct TabulationChars<R, J, true> {
+    __attribute__((always_inline)) static inline typename R::Entry
+    Hash(const typename R::Key &, const typename R::Entry *) {
+        return 0;
+    }
+};
+
+// Character j of each 64-bit lane: a byte shuffle for 8- and 16-bit
+// characters, as in zobrist_batch and wzobrist_batch.
+template <int WIDTH>
+struct TabulationLanes {
+#if defined(__AVX512F__)
+    __attribute__((always_inline)) static inline __m512i
+    Character(__m512i x, int j) {
+#if defined(__AVX512BW__)
+        if (WIDTH == 8) return byte_epi64_si512(x, j);
+        if (WIDTH == 16) return short_epi64_si512(x, j);
+#endif
+        return _mm512_and_si512(_mm512_srli_epi64(x, j * WIDTH),
+                                _mm512_set1_epi64((1 << WIDTH) - 1));
+    }
+#endif
+#if defined(__AVX2__)
+    __attribute__((always_inline)) static inline __m256i
+    Character(__m256i x, int j) {
+        if (WIDTH == 8) return byte_epi64_si256(x, j);
+        if (WIDTH == 16) return short_epi64_si256(x, j);
+        return _mm256_and_si256(_mm256_srli_epi64(x, j * WIDTH),
+                                _mm256_set1_epi64x((1 << WIDTH) - 1));
+    }
+#endif
+};
+
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+__attribute__((always_inline)) inline
+    typename TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS>::Key
+    Tabulation(typename TabulationRandomness<KEY_BITS, CHAR_BITS,
+                                             OUT_BITS>::Key x,
+               const TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> *r) {
+    typedef TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> R;
+    return TabulationChars<R>::Hash(x, r->hashtab);
+}
+
+// The vector loops gather the entries of 8 (AVX-512) or 4 (AVX2) keys per
+// character from the table of that character: 64-bit keys use 64-bit
+// indexes, 32-bit entries are gathered into half-width vectors and widened
+// when stored.
+template <typename R, typename Key = typename R::Key,
+          typename Entry = typename R::Entry>
+struct TabulationGather;
+
+template <typename R>
+struct TabulationGather<R, uint64_t, uint64_t> {
+    typedef TabulationLanes<R::CHARACTER_BITS> Lanes;
+    static inline size_t Batch(const uint64_t *in, uint64_t *out, size_t n,
+                               const R *r) {
+        size_t i = 0;
+        const long long *t = reinterpret_cast<const long long *>(r->hashtab);
+#if defined(__AVX512F__)
+        for (; i + 8 <= n; i += 8) {
+            const __m512i x = _mm512_loadu_si512(in + i);
+            __m512i h = _mm512_setzero_si512();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m512i c = Lanes::Character(x, j);
+                h = _mm512_xor_si512(
+                    h, _mm512_i64gather_epi64(c, t + j * R::TABLE_SIZE, 8));
+            }
+            _mm512_storeu_si512(out + i, h);
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+            __m256i h = _mm256_setzero_si256();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m256i c = Lanes::Character(x, j);
+                h = _mm256_xor_si256(
+                    h, _mm256_i64gather_epi64(t + j * R::TABLE_SIZE, c, 8));
+            }
+            _mm256_storeu_si256((__m256i *)(out + i), h);
+        }
+#else
+        (void)in, (void)out, (void)n, (void)t;
+#endif
+        return i;
+    }
+};
+
+template <typename R>
+struct TabulationGather<R, uint64_t, uint32_t> {
+    typedef TabulationLanes<R::CHARACTER_BITS> Lanes;
+    static inline size_t Batch(const uint64_t *in, uint64_t *out, size_t n,
+                               const R *r) {
+        size_t i = 0;
+        const int *t = reinterpret_cast<const int *>(r->hashtab);
+#if defined(__AVX512F__)
+        for (; i + 8 <= n; i += 8) {
+            const __m512i x = _mm512_loadu_si512(in + i);
+            __m256i h = _mm256_setzero_si256();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m512i c = Lanes::Character(x, j);
+                h = _mm256_xor_si256(
+                    h, _mm512_i64gather_epi32(c, t + j * R::TABLE_SIZE, 4));
+            }
+            _mm512_storeu_si512(out + i, _mm512_cvtepu32_epi64(h));
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+            __m128i h = _mm_setzero_si128();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m256i c = Lanes::Character(x, j);
+                h = _mm_xor_si128(
+                    h, _mm256_i64gather_epi32(t + j * R::TABLE_SIZE, c, 4));
+            }
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu32_epi64(h));
+        }
+#else
+        (void)in, (void)out, (void)n, (void)t;
+#endif
+        return i;
+    }
+};
+
+// 32-bit keys: 16 (AVX-512) or 8 (AVX2) keys per vector
+template <typename R>
+struct TabulationGather<R, uint32_t, uint32_t> {
+    static inline size_t Batch(const uint32_t *in, uint32_t *out, size_t n,
+                               const R *r) {
+        size_t i = 0;
+        const int *t = reinterpret_cast<const int *>(r->hashtab);
+#if defined(__AVX512F__)
+        const __m512i mask = _mm512_set1_epi32(R::TABLE_SIZE - 1);
+        for (; i + 16 <= n; i += 16) {
+            const __m512i x = _mm512_loadu_si512(in + i);
+            __m512i h = _mm512_setzero_si512();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m512i c = _mm512_and_si512(
+                    _mm512_srli_epi32(x, j * R::CHARACTER_BITS), mask);
+                h = _mm512_xor_si512(
+                    h, _mm512_i32gather_epi32(c, t + j * R::TABLE_SIZE, 4));
+            }
+            _mm512_storeu_si512(out + i, h);
+        }
+#elif defined(__AVX2__)
+        const __m256i mask = _mm256_set1_epi32(R::TABLE_SIZE - 1);
+        for (; i + 8 <= n; i += 8) {
+            const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+            __m256i h = _mm256_setzero_si256();
+            for (int j = 0; j < R::CHARS; ++j) {
+                const __m256i c = _mm256_and_si256(
+                    _mm256_srli_epi32(x, j * R::CHARACTER_BITS), mask);
+                h = _mm256_xor_si256(
+                    h, _mm256_i32gather_epi32(t + j * R::TABLE_SIZE, c, 4));
+            }
+            _mm256_storeu_si256((__m256i *)(out + i), h);
+        }
+#else
+        (void)in, (void)out, (void)n, (void)t;
+#endif
+        return i;
+    }
+};
+
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+void TabulationBatch(
+    const typename TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS>::Key *in,
+    typename TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS>::Key *out,
+    size_t n, const TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> *r) {
+    typedef TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS> R;
+    for (size_t i = TabulationGather<R>::Batch(in, out, n, r); i < n; ++i) {
+        out[i] = Tabulation<KEY_BITS, CHAR_BITS, OUT_BITS>(in[i], r);
+    }
+}
+
+// e.g. "T64c11o32": 64-bit keys, 11-bit characters, 32-bit entries
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+struct TabulationPack
+        : public GenericPack<
+              typename TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS>::Key,
+              TabulationRandomness<KEY_BITS, CHAR_BITS, OUT_BITS>,
+              TabulationInit<KEY_BITS, CHAR_BITS, OUT_BITS>,
+              Tabulation<KEY_BITS, CHAR_BITS, OUT_BITS>, HashBits::LOW,
+              TabulationBatch<KEY_BITS, CHAR_BITS, OUT_BITS>> {
+    using TabulationPack::GenericPack::GenericPack;
+    static constexpr char NAME[] = {'T',
+                                    char('0' + KEY_BITS / 10),
+                                    char('0' + KEY_BITS % 10),
+                                    'c',
+                                    char('0' + CHAR_BITS / 10),
+                                    char('0' + CHAR_BITS % 10),
+                                    'o',
+                                    char('0' + OUT_BITS / 10),
+                                    char('0' + OUT_BITS % 10),
+                                    '\0'};
+};
+
+template <int KEY_BITS, int CHAR_BITS, int OUT_BITS>
+constexpr char TabulationPack<KEY_BITS, CHAR_BITS, OUT_BITS>::NAME[];
+
+/**
+* Simple tabulation with OUTPUTS hash functions in one pass: the entry of a
+* character holds its OUTPUTS rows side by side, so that each character is
+* one load of OUTPUTS words instead of OUTPUTS lookups. See MultiPack.
+*/
+template <int KEY_BITS, int CHAR_BITS, int OUTPUTS_P>
+struct TabulationMultiPack {
+    typedef TabulationRandomness<KEY_BITS, CHAR_BITS, KEY_BITS> Layout;
+    typedef typename Layout::Key Word;
+    static constexpr int OUTPUTS = OUTPUTS_P;
+    struct Randomness {
+        Word hashtab[Layout::ENTRIES][OUTPUTS];
+    };
+
+    static inline void InitRandomness(Randomness *r) {
+        if (KEY_BITS == 64) {
+            fill64rand(reinterpret_cast<uint64_t *>(r->hashtab),
+                       Layout::ENTRIES * OUTPUTS);
+        } else {
+            fill32rand(reinterpret_cast<uint32_t *>(r->hashtab),
+                       Layout::ENTRIES * OUTPUTS);
+        }
+    }
+
+    static inline void InitRandomness(Randomness *r, uint64_t seed) {
+        SeededInitRandomness<TabulationMultiPack>(r, seed);
+    }
+
+    template <int K>
+    __attribute__((always_inline)) static inline void
+    HashMulti(Word x, Word *out, const Randomness *r) {
+        static_assert(0 < K && K <= OUTPUTS, "1 to OUTPUTS hashes");
+        const Word mask = Word(Layout::TABLE_SIZE - 1);
+        // accumulated apart from out, which could alias the table
+        Word h[K];
+        const Word *row = r->hashtab[x & mask];
+        for (int i = 0; i < K; ++i) {
+            h[i] = row[i];
+        }
+        for (int j = 1; j < Layout::CHARS; ++j) {
+            row = r->hashtab[j * Layout::TABLE_SIZE +
+                             ((x >> (j * CHAR_BITS)) & mask)];
+            for (int i = 0; i < K; ++i) {
+                h[i] ^= row[i];
+            }
+        }
+        for (int i = 0; i < K; ++i) {
+            out[i] = h[i];
+        }
+    }
+
+    // e.g. "T64c08x04": 64-bit keys, 8-bit characters, 4 outputs
+    static constexpr char NAME[] = {'T',
+                                    char('0' + KEY_BITS / 10),
+                                    char('0' + KEY_BITS % 10),
+                                    'c',
+                                    char('0' + CHAR_BITS / 10),
+                                    char('0' + CHAR_BITS % 10),
+                                    'x',
+                                    char('0' + OUTPUTS / 10),
+                                    char('0' + OUTPUTS % 10),
+                                    '\0'};
+};
+
+template <int KEY_BITS, int CHAR_BITS, int OUTPUTS>
+constexpr char TabulationMultiPack<KEY_BITS, CHAR_BITS, OUTPUTS>::NAME[];
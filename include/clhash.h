@@ -3,8 +3,7 @@
 
 #include <stdint.h>
 
-#include <immintrin.h> // x86 intrinsics
-
+#include "simd.h" // x86 intrinsics
 #include "util.h"
 
 /**************
@@ -30,6 +29,36 @@ inline uint64_t cl_bitmixing(uint64_t x, const cl_bitmixing_t *t) {
     return _mm_cvtsi128_si64(shifted_product);
 }
 
+// The batch kernels of this file run the scalar code on each 128-bit lane of
+// a 512-bit (or 256-bit) register with VPCLMULQDQ, so that each carry-less
+// multiplication handles 4 (or 2) keys. See load_split_epi64_si512.
+void cl_bitmixing_batch(const uint64_t *in, uint64_t *out, size_t n,
+                        const cl_bitmixing_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = _mm512_bsrli_epi128(_mm512_clmulepi64_epi128(even, multiplier, 0x00), 4);
+        odd = _mm512_bsrli_epi128(_mm512_clmulepi64_epi128(odd, multiplier, 0x00), 4);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = _mm256_bsrli_epi128(_mm256_clmulepi64_epi128(even, multiplier, 0x00), 4);
+        odd = _mm256_bsrli_epi128(_mm256_clmulepi64_epi128(odd, multiplier, 0x00), 4);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_bitmixing(in[i], t);
+    }
+}
+
 
 
 
@@ -70,6 +99,58 @@ static inline __m128i fastreduction64_si128_for_small_A(__m128i A) {
     return final;
 }
 
+// reduction64_si128 and fastreduction64_si128_for_small_A on each 128-bit
+// lane, for the batch kernels
+#if defined(SHORTHASH_VPCLMUL512) || defined(SHORTHASH_VPCLMUL256)
+__attribute__((always_inline))
+static inline __m128i reduction64_polynomial_si128() {
+    return _mm_cvtsi64_si128((1U << 4) + (1U << 3) + (1U << 1) + (1U << 0));
+}
+
+__attribute__((always_inline))
+static inline __m128i reduction64_shuffle_si128() {
+    return _mm_setr_epi8(0, 27, 54, 45, 108, 119, 90, 65, char(216), char(195),
+                         char(238), char(245), char(180), char(175), char(130),
+                         char(153));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i reduction64_si512(__m512i A) {
+    const __m512i C = _mm512_broadcast_i32x4(reduction64_polynomial_si128());
+    __m512i Q2 = _mm512_clmulepi64_epi128(A, C, 0x01);
+    const __m512i shuffle = _mm512_broadcast_i32x4(reduction64_shuffle_si128());
+    __m512i Q3 = _mm512_shuffle_epi8(shuffle, _mm512_bsrli_epi128(Q2, 8));
+    __m512i Q4 = _mm512_xor_si512(Q2, A);
+    return _mm512_xor_si512(Q3, Q4);
+}
+
+__attribute__((always_inline))
+static inline __m512i fastreduction64_si512_for_small_A(__m512i A) {
+    const __m512i C = _mm512_broadcast_i32x4(reduction64_polynomial_si128());
+    return _mm512_xor_si512(_mm512_clmulepi64_epi128(A, C, 0x01), A);
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i reduction64_si256(__m256i A) {
+    const __m256i C = _mm256_broadcastsi128_si256(reduction64_polynomial_si128());
+    __m256i Q2 = _mm256_clmulepi64_epi128(A, C, 0x01);
+    const __m256i shuffle = _mm256_broadcastsi128_si256(reduction64_shuffle_si128());
+    __m256i Q3 = _mm256_shuffle_epi8(shuffle, _mm256_bsrli_epi128(Q2, 8));
+    __m256i Q4 = _mm256_xor_si256(Q2, A);
+    return _mm256_xor_si256(Q3, Q4);
+}
+
+__attribute__((always_inline))
+static inline __m256i fastreduction64_si256_for_small_A(__m256i A) {
+    const __m256i C = _mm256_broadcastsi128_si256(reduction64_polynomial_si128());
+    return _mm256_xor_si256(_mm256_clmulepi64_epi128(A, C, 0x01), A);
+}
+#endif
+
 /***
 * Follows a 64-bit linear hash
 **/
@@ -106,6 +187,243 @@ inline uint32_t cl_linear32(uint32_t x, const cl_linear_t *t) {
     return _mm_cvtsi128_si32(fastreduction64_si128_for_small_A(productplusconstant));
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_linear_si512(__m512i x, __m512i multiplier,
+                                      __m512i constant) {
+    __m512i product = _mm512_clmulepi64_epi128(x, multiplier, 0x00);
+    return reduction64_si512(_mm512_xor_si512(product, constant));
+}
+
+__attribute__((always_inline))
+static inline __m512i cl_linear32_si512(__m512i x, __m512i multiplier,
+                                        __m512i constant) {
+    __m512i product = _mm512_clmulepi64_epi128(x, multiplier, 0x00);
+    return fastreduction64_si512_for_small_A(_mm512_xor_si512(product, constant));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_linear_si256(__m256i x, __m256i multiplier,
+                                      __m256i constant) {
+    __m256i product = _mm256_clmulepi64_epi128(x, multiplier, 0x00);
+    return reduction64_si256(_mm256_xor_si256(product, constant));
+}
+
+__attribute__((always_inline))
+static inline __m256i cl_linear32_si256(__m256i x, __m256i multiplier,
+                                        __m256i constant) {
+    __m256i product = _mm256_clmulepi64_epi128(x, multiplier, 0x00);
+    return fastreduction64_si256_for_small_A(_mm256_xor_si256(product, constant));
+}
+#endif
+
+void cl_linear_batch(const uint64_t *in, uint64_t *out, size_t n,
+                     const cl_linear_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = cl_linear_si512(even, multiplier, constant);
+        odd = cl_linear_si512(odd, multiplier, constant);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = cl_linear_si256(even, multiplier, constant);
+        odd = cl_linear_si256(odd, multiplier, constant);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_linear(in[i], t);
+    }
+}
+
+// cl_linear(newval, t) given h = cl_linear(oldval, t). The reduction is
+// GF(2)-linear, so h changes by the product with oldval ^ newval; the
+// constant (below 2^64) reduces to itself and cancels.
+inline uint64_t cl_linear_update(uint64_t h, uint64_t oldval, uint64_t newval,
+                                 const cl_linear_t *t) {
+    return h ^ cl_linear(oldval ^ newval, t) ^
+           (uint64_t)_mm_cvtsi128_si64(t->constant);
+}
+
+void cl_linear32_batch(const uint32_t *in, uint32_t *out, size_t n,
+                       const cl_linear_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epu32_si512(in + i, &even, &odd);
+        even = cl_linear32_si512(even, multiplier, constant);
+        odd = cl_linear32_si512(odd, multiplier, constant);
+        store_merge_epi32_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epu32_si256(in + i, &even, &odd);
+        even = cl_linear32_si256(even, multiplier, constant);
+        odd = cl_linear32_si256(odd, multiplier, constant);
+        store_merge_epi32_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_linear32(in[i], t);
+    }
+}
+
+/***
+* Several cl_linear functions of one key: output i uses multiplier[i] and
+* constant[i]. With VPCLMULQDQ a carry-less multiply covers 4 outputs (one
+* per 128-bit lane) and so does the reduction. The constants are added after
+* the reduction, which leaves them (below 2^64) unchanged.
+**/
+#define CL_LINEAR_MULTI_MAX 8
+
+typedef struct cl_linear_multi_s {
+    uint64_t multiplier[CL_LINEAR_MULTI_MAX];
+    uint64_t constant[CL_LINEAR_MULTI_MAX];
+} cl_linear_multi_t;
+
+void cl_linear_multi_init(cl_linear_multi_t *k) {
+    fill64rand(k->multiplier, CL_LINEAR_MULTI_MAX);
+    fill64rand(k->constant, CL_LINEAR_MULTI_MAX);
+}
+
+// out[i] = A_i x + B_i for i < k <= CL_LINEAR_MULTI_MAX. From 4 outputs on,
+// all eight come from two 512-bit products (fewer were measured faster in
+// scalar registers, where the masked store does not pay off).
+__attribute__((always_inline))
+inline void cl_linear_multi(uint64_t x, uint64_t *out, int k,
+                            const cl_linear_multi_t *t) {
+    int i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    if (k > 3) {
+        const __m512i xs = _mm512_set1_epi64(x);
+        const __m512i m = _mm512_loadu_si512(t->multiplier);
+        // outputs 0, 2, 4, 6 and 1, 3, 5, 7
+        const __m512i even =
+            reduction64_si512(_mm512_clmulepi64_epi128(xs, m, 0x00));
+        const __m512i odd =
+            reduction64_si512(_mm512_clmulepi64_epi128(xs, m, 0x10));
+        const __m512i h = _mm512_xor_si512(_mm512_unpacklo_epi64(even, odd),
+                                           _mm512_loadu_si512(t->constant));
+        if (k == CL_LINEAR_MULTI_MAX) {
+            _mm512_storeu_si512(out, h);
+        } else {
+            // a masked store would stall the loads of out that follow
+            uint64_t all[CL_LINEAR_MULTI_MAX];
+            _mm512_storeu_si512(all, h);
+            for (; i < k; ++i) out[i] = all[i];
+        }
+        return;
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    for (; i + 4 <= k; i += 4) {
+        const __m256i xs = _mm256_set1_epi64x(x);
+        const __m256i m =
+            _mm256_loadu_si256((const __m256i *)(t->multiplier + i));
+        const __m256i even =
+            reduction64_si256(_mm256_clmulepi64_epi128(xs, m, 0x00));
+        const __m256i odd =
+            reduction64_si256(_mm256_clmulepi64_epi128(xs, m, 0x10));
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_xor_si256(_mm256_unpacklo_epi64(even, odd),
+                             _mm256_loadu_si256(
+                                 (const __m256i *)(t->constant + i))));
+    }
+#endif
+    for (; i < k; ++i) {
+        const __m128i product = _mm_clmulepi64_si128(
+            _mm_cvtsi64_si128(x), _mm_cvtsi64_si128(t->multiplier[i]), 0x00);
+        out[i] = (uint64_t)_mm_cvtsi128_si64(reduction64_si128(product)) ^
+                 t->constant[i];
+    }
+}
+
+/***
+* 128-bit keys (UUIDs, IPv6 addresses): the limbs x0 (low 64 bits) and x1
+* (high 64 bits) of the key get a multiplier each, and the sum is reduced
+* once. A 128-bit key fills a 128-bit lane, so the batch kernels need no
+* splitting. The hash is 64 bits, in the low half of the uint128_t.
+**/
+
+__attribute__((always_inline))
+static inline __m128i cl_load_u128(uint128_t x) {
+    return _mm_set_epi64x((long long)(x >> 64), (long long)x);
+}
+
+typedef struct cl_linear128_s {
+    __m128i multiplier; // A0 in the low 64 bits, A1 in the high 64 bits
+    __m128i constant;   // high 64-bit should be zero
+} cl_linear128_t;
+
+void cl_linear128_init(cl_linear128_t *k) {
+    k->multiplier = _mm_set_epi64x(get64rand(), get64rand());
+    k->constant = _mm_cvtsi64_si128(get64rand());
+}
+
+// A0 x0 + A1 x1 + B modulo, strongly universal like cl_linear
+__attribute__((always_inline))
+inline uint128_t cl_linear128(uint128_t x, const cl_linear128_t *t) {
+    const __m128i input = cl_load_u128(x);
+    __m128i sum = _mm_xor_si128(
+        _mm_clmulepi64_si128(input, t->multiplier, 0x00),
+        _mm_clmulepi64_si128(input, t->multiplier, 0x11));
+    sum = _mm_xor_si128(sum, t->constant);
+    return (uint64_t)_mm_cvtsi128_si64(reduction64_si128(sum));
+}
+
+void cl_linear128_batch(const uint128_t *in, uint128_t *out, size_t n,
+                        const cl_linear128_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        __m512i sum = _mm512_xor_si512(
+            _mm512_clmulepi64_epi128(x, multiplier, 0x00),
+            _mm512_clmulepi64_epi128(x, multiplier, 0x11));
+        sum = _mm512_xor_si512(sum, constant);
+        // clear the garbage left in the high halves by the reduction
+        _mm512_storeu_si512(out + i,
+                            _mm512_maskz_mov_epi64(0x55, reduction64_si512(sum)));
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 2 <= n; i += 2) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i sum = _mm256_xor_si256(
+            _mm256_clmulepi64_epi128(x, multiplier, 0x00),
+            _mm256_clmulepi64_epi128(x, multiplier, 0x11));
+        sum = _mm256_xor_si256(sum, constant);
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_blend_epi32(_mm256_setzero_si256(),
+                                               reduction64_si256(sum), 0x33));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_linear128(in[i], t);
+    }
+}
+
 
 /***
 * Follows a 64-bit quadratic hash
@@ -136,6 +454,150 @@ inline uint64_t cl_quadratic(uint64_t x, const cl_quadratic_t *t) {
     return _mm_cvtsi128_si64(answer);
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_quadratic_si512(__m512i x, __m512i multiplier,
+                                         __m512i constant) {
+    __m512i inputsquare =
+        reduction64_si512(_mm512_clmulepi64_epi128(x, x, 0x00));
+    __m512i product1 = _mm512_clmulepi64_epi128(x, multiplier, 0x00);
+    __m512i product2 = _mm512_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m512i sum = _mm512_xor_si512(product1, constant);
+    sum = _mm512_xor_si512(sum, product2);
+    return reduction64_si512(sum);
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_quadratic_si256(__m256i x, __m256i multiplier,
+                                         __m256i constant) {
+    __m256i inputsquare =
+        reduction64_si256(_mm256_clmulepi64_epi128(x, x, 0x00));
+    __m256i product1 = _mm256_clmulepi64_epi128(x, multiplier, 0x00);
+    __m256i product2 = _mm256_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m256i sum = _mm256_xor_si256(product1, constant);
+    sum = _mm256_xor_si256(sum, product2);
+    return reduction64_si256(sum);
+}
+#endif
+
+void cl_quadratic_batch(const uint64_t *in, uint64_t *out, size_t n,
+                        const cl_quadratic_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = cl_quadratic_si512(even, multiplier, constant);
+        odd = cl_quadratic_si512(odd, multiplier, constant);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = cl_quadratic_si256(even, multiplier, constant);
+        odd = cl_quadratic_si256(odd, multiplier, constant);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_quadratic(in[i], t);
+    }
+}
+
+/***
+* cl_quadratic for 128-bit keys: Q0(x0) + Q1(x1) + C, where each Qi(y) is
+* Ai y^2 + Bi y. Like simple tabulation over the two limbs, with 3-wise
+* independent character hashes, it is 3-wise independent.
+**/
+
+typedef struct cl_quadratic128_s {
+    __m128i multiplier;       // B0 in the low 64 bits, B1 in the high 64 bits
+    __m128i squaremultiplier; // A0 in the low 64 bits, A1 in the high 64 bits
+    __m128i constant;         // high 64-bit should be zero
+} cl_quadratic128_t;
+
+void cl_quadratic128_init(cl_quadratic128_t *k) {
+    k->multiplier = _mm_set_epi64x(get64rand(), get64rand());
+    k->squaremultiplier = _mm_set_epi64x(get64rand(), get64rand());
+    k->constant = _mm_cvtsi64_si128(get64rand());
+}
+
+__attribute__((always_inline))
+inline uint128_t cl_quadratic128(uint128_t x, const cl_quadratic128_t *t) {
+    const __m128i input = cl_load_u128(x);
+    const __m128i squares = _mm_unpacklo_epi64(
+        reduction64_si128(_mm_clmulepi64_si128(input, input, 0x00)),
+        reduction64_si128(_mm_clmulepi64_si128(input, input, 0x11)));
+    __m128i sum = _mm_xor_si128(
+        _mm_clmulepi64_si128(input, t->multiplier, 0x00),
+        _mm_clmulepi64_si128(input, t->multiplier, 0x11));
+    sum = _mm_xor_si128(sum, _mm_clmulepi64_si128(squares, t->squaremultiplier,
+                                                  0x00));
+    sum = _mm_xor_si128(sum, _mm_clmulepi64_si128(squares, t->squaremultiplier,
+                                                  0x11));
+    sum = _mm_xor_si128(sum, t->constant);
+    return (uint64_t)_mm_cvtsi128_si64(reduction64_si128(sum));
+}
+
+void cl_quadratic128_batch(const uint128_t *in, uint128_t *out, size_t n,
+                           const cl_quadratic128_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i squaremultiplier =
+        _mm512_broadcast_i32x4(t->squaremultiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        const __m512i squares = _mm512_unpacklo_epi64(
+            reduction64_si512(_mm512_clmulepi64_epi128(x, x, 0x00)),
+            reduction64_si512(_mm512_clmulepi64_epi128(x, x, 0x11)));
+        __m512i sum = _mm512_xor_si512(
+            _mm512_clmulepi64_epi128(x, multiplier, 0x00),
+            _mm512_clmulepi64_epi128(x, multiplier, 0x11));
+        sum = _mm512_xor_si512(sum, constant);
+        sum = _mm512_xor_si512(
+            sum, _mm512_clmulepi64_epi128(squares, squaremultiplier, 0x00));
+        sum = _mm512_xor_si512(
+            sum, _mm512_clmulepi64_epi128(squares, squaremultiplier, 0x11));
+        _mm512_storeu_si512(out + i,
+                            _mm512_maskz_mov_epi64(0x55, reduction64_si512(sum)));
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i squaremultiplier =
+        _mm256_broadcastsi128_si256(t->squaremultiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 2 <= n; i += 2) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        const __m256i squares = _mm256_unpacklo_epi64(
+            reduction64_si256(_mm256_clmulepi64_epi128(x, x, 0x00)),
+            reduction64_si256(_mm256_clmulepi64_epi128(x, x, 0x11)));
+        __m256i sum = _mm256_xor_si256(
+            _mm256_clmulepi64_epi128(x, multiplier, 0x00),
+            _mm256_clmulepi64_epi128(x, multiplier, 0x11));
+        sum = _mm256_xor_si256(
+            sum, _mm256_clmulepi64_epi128(squares, squaremultiplier, 0x00));
+        sum = _mm256_xor_si256(
+            sum, _mm256_clmulepi64_epi128(squares, squaremultiplier, 0x11));
+        sum = _mm256_xor_si256(sum, constant);
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_blend_epi32(_mm256_setzero_si256(),
+                                               reduction64_si256(sum), 0x33));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_quadratic128(in[i], t);
+    }
+}
+
 
 /***
 * Follows a fast version of the quadratic hash
@@ -177,6 +639,184 @@ inline uint64_t cl_fastquadratic(uint64_t x, const cl_fastquadratic_t *t) {
     return _mm_cvtsi128_si64(answer);
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_fastquadratic_si512(__m512i x, __m512i multiplier,
+                                             __m512i shiftmultiplier,
+                                             __m512i constant) {
+    __m512i inputsquare = _mm512_clmulepi64_epi128(x, x, 0x00);
+    __m512i product1 = _mm512_clmulepi64_epi128(x, multiplier, 0x00);
+    __m512i product2 = _mm512_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m512i product3 =
+        _mm512_clmulepi64_epi128(inputsquare, shiftmultiplier, 0x01);
+    __m512i sum1 = _mm512_xor_si512(product1, constant);
+    __m512i sum2 = _mm512_xor_si512(product2, product3);
+    return reduction64_si512(_mm512_xor_si512(sum1, sum2));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_fastquadratic_si256(__m256i x, __m256i multiplier,
+                                             __m256i shiftmultiplier,
+                                             __m256i constant) {
+    __m256i inputsquare = _mm256_clmulepi64_epi128(x, x, 0x00);
+    __m256i product1 = _mm256_clmulepi64_epi128(x, multiplier, 0x00);
+    __m256i product2 = _mm256_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m256i product3 =
+        _mm256_clmulepi64_epi128(inputsquare, shiftmultiplier, 0x01);
+    __m256i sum1 = _mm256_xor_si256(product1, constant);
+    __m256i sum2 = _mm256_xor_si256(product2, product3);
+    return reduction64_si256(_mm256_xor_si256(sum1, sum2));
+}
+#endif
+
+void cl_fastquadratic_batch(const uint64_t *in, uint64_t *out, size_t n,
+                            const cl_fastquadratic_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i shiftmultiplier = _mm512_broadcast_i32x4(t->shiftmultiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = cl_fastquadratic_si512(even,
+                                      multiplier, shiftmultiplier, constant);
+        odd = cl_fastquadratic_si512(odd,
+                                     multiplier, shiftmultiplier, constant);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i shiftmultiplier = _mm256_broadcastsi128_si256(t->shiftmultiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = cl_fastquadratic_si256(even,
+                                      multiplier, shiftmultiplier, constant);
+        odd = cl_fastquadratic_si256(odd,
+                                     multiplier, shiftmultiplier, constant);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_fastquadratic(in[i], t);
+    }
+}
+
+/***
+* Several cl_fastquadratic functions of one key, as cl_linear_multi does for
+* cl_linear: output i is A_i x + B_i x^2 + C_i modulo, with
+* A_i = multiplier[i], B_i = squaremultiplier[i] and C_i = constant[i]. The
+* square is computed once for all outputs. For 32-bit keys the square fits in
+* 64 bits, and output i is the joint pair of cl_fastquadratic32 with the
+* multiplier (A_i, B_i).
+**/
+#define CL_FASTQUADRATIC_MULTI_MAX 8
+
+typedef struct cl_fastquadratic_multi_s {
+    uint64_t multiplier[CL_FASTQUADRATIC_MULTI_MAX];
+    uint64_t squaremultiplier[CL_FASTQUADRATIC_MULTI_MAX];
+    // B_i x^64 modulo, for the high half of the square
+    uint64_t shiftmultiplier[CL_FASTQUADRATIC_MULTI_MAX];
+    uint64_t constant[CL_FASTQUADRATIC_MULTI_MAX];
+} cl_fastquadratic_multi_t;
+
+void cl_fastquadratic_multi_init(cl_fastquadratic_multi_t *k) {
+    fill64rand(k->multiplier, CL_FASTQUADRATIC_MULTI_MAX);
+    fill64rand(k->squaremultiplier, CL_FASTQUADRATIC_MULTI_MAX);
+    fill64rand(k->constant, CL_FASTQUADRATIC_MULTI_MAX);
+    // the precomputation of cl_fastquadratic_init, for each output
+    const __m128i reduc1to64 = reduction64_si128(_mm_set_epi64x(UINT64_C(1), 0));
+    for (int i = 0; i < CL_FASTQUADRATIC_MULTI_MAX; ++i) {
+        const __m128i product = _mm_clmulepi64_si128(
+            reduc1to64, _mm_cvtsi64_si128(k->squaremultiplier[i]), 0x00);
+        k->shiftmultiplier[i] =
+            (uint64_t)_mm_cvtsi128_si64(reduction64_si128(product));
+    }
+}
+
+// out[i] = A_i x + B_i x^2 + C_i for i < k <= CL_FASTQUADRATIC_MULTI_MAX,
+// with the 512-bit path from 4 outputs on as in cl_linear_multi.
+__attribute__((always_inline))
+inline void cl_fastquadratic_multi(uint64_t x, uint64_t *out, int k,
+                                   const cl_fastquadratic_multi_t *t) {
+    const __m128i input = _mm_cvtsi64_si128(x);
+    const __m128i square = _mm_clmulepi64_si128(input, input, 0x00);
+    int i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    if (k > 3) {
+        // x, the low and the high half of the square in every 128-bit lane
+        const __m512i xs = _mm512_set1_epi64(x);
+        const __m512i squarelow = _mm512_broadcastq_epi64(square);
+        const __m512i squarehigh =
+            _mm512_broadcastq_epi64(_mm_unpackhi_epi64(square, square));
+        const __m512i a = _mm512_loadu_si512(t->multiplier);
+        const __m512i b = _mm512_loadu_si512(t->squaremultiplier);
+        const __m512i c = _mm512_loadu_si512(t->shiftmultiplier);
+        // outputs 0, 2, 4, 6 and 1, 3, 5, 7
+        const __m512i even = reduction64_si512(_mm512_xor_si512(
+            _mm512_clmulepi64_epi128(xs, a, 0x00),
+            _mm512_xor_si512(_mm512_clmulepi64_epi128(squarelow, b, 0x00),
+                             _mm512_clmulepi64_epi128(squarehigh, c, 0x00))));
+        const __m512i odd = reduction64_si512(_mm512_xor_si512(
+            _mm512_clmulepi64_epi128(xs, a, 0x10),
+            _mm512_xor_si512(_mm512_clmulepi64_epi128(squarelow, b, 0x10),
+                             _mm512_clmulepi64_epi128(squarehigh, c, 0x10))));
+        const __m512i h = _mm512_xor_si512(_mm512_unpacklo_epi64(even, odd),
+                                           _mm512_loadu_si512(t->constant));
+        if (k == CL_FASTQUADRATIC_MULTI_MAX) {
+            _mm512_storeu_si512(out, h);
+        } else {
+            // a masked store would stall the loads of out that follow
+            uint64_t all[CL_FASTQUADRATIC_MULTI_MAX];
+            _mm512_storeu_si512(all, h);
+            for (; i < k; ++i) out[i] = all[i];
+        }
+        return;
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i xs = _mm256_set1_epi64x(x);
+    const __m256i squarelow = _mm256_broadcastq_epi64(square);
+    const __m256i squarehigh =
+        _mm256_broadcastq_epi64(_mm_unpackhi_epi64(square, square));
+    for (; i + 4 <= k; i += 4) {
+        const __m256i a = _mm256_loadu_si256((const __m256i *)(t->multiplier + i));
+        const __m256i b =
+            _mm256_loadu_si256((const __m256i *)(t->squaremultiplier + i));
+        const __m256i c =
+            _mm256_loadu_si256((const __m256i *)(t->shiftmultiplier + i));
+        const __m256i even = reduction64_si256(_mm256_xor_si256(
+            _mm256_clmulepi64_epi128(xs, a, 0x00),
+            _mm256_xor_si256(_mm256_clmulepi64_epi128(squarelow, b, 0x00),
+                             _mm256_clmulepi64_epi128(squarehigh, c, 0x00))));
+        const __m256i odd = reduction64_si256(_mm256_xor_si256(
+            _mm256_clmulepi64_epi128(xs, a, 0x10),
+            _mm256_xor_si256(_mm256_clmulepi64_epi128(squarelow, b, 0x10),
+                             _mm256_clmulepi64_epi128(squarehigh, c, 0x10))));
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_xor_si256(_mm256_unpacklo_epi64(even, odd),
+                             _mm256_loadu_si256(
+                                 (const __m256i *)(t->constant + i))));
+    }
+#endif
+    for (; i < k; ++i) {
+        const __m128i sum = _mm_xor_si128(
+            _mm_clmulepi64_si128(input, _mm_cvtsi64_si128(t->multiplier[i]),
+                                 0x00),
+            _mm_xor_si128(
+                _mm_clmulepi64_si128(
+                    square, _mm_cvtsi64_si128(t->squaremultiplier[i]), 0x00),
+                _mm_clmulepi64_si128(
+                    square, _mm_cvtsi64_si128(t->shiftmultiplier[i]), 0x01)));
+        out[i] = (uint64_t)_mm_cvtsi128_si64(reduction64_si128(sum)) ^
+                 t->constant[i];
+    }
+}
+
 
 typedef struct cl_fastquadratic32_s {
     __m128i multiplier;
@@ -207,6 +847,59 @@ inline uint32_t cl_fastquadratic32(uint32_t x, const cl_fastquadratic32_t *t) {
     return _mm_cvtsi128_si32(answer);
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_fastquadratic32_si512(__m512i x, __m512i multiplier,
+                                               __m512i constant) {
+    __m512i inputsquare = _mm512_clmulepi64_epi128(x, x, 0x00);
+    __m512i product1 = _mm512_clmulepi64_epi128(x, multiplier, 0x00);
+    __m512i product2 = _mm512_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m512i sum1 = _mm512_xor_si512(product1, constant);
+    return reduction64_si512(_mm512_xor_si512(sum1, product2));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_fastquadratic32_si256(__m256i x, __m256i multiplier,
+                                               __m256i constant) {
+    __m256i inputsquare = _mm256_clmulepi64_epi128(x, x, 0x00);
+    __m256i product1 = _mm256_clmulepi64_epi128(x, multiplier, 0x00);
+    __m256i product2 = _mm256_clmulepi64_epi128(inputsquare, multiplier, 0x10);
+    __m256i sum1 = _mm256_xor_si256(product1, constant);
+    return reduction64_si256(_mm256_xor_si256(sum1, product2));
+}
+#endif
+
+void cl_fastquadratic32_batch(const uint32_t *in, uint32_t *out, size_t n,
+                              const cl_fastquadratic32_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier = _mm512_broadcast_i32x4(t->multiplier);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epu32_si512(in + i, &even, &odd);
+        even = cl_fastquadratic32_si512(even, multiplier, constant);
+        odd = cl_fastquadratic32_si512(odd, multiplier, constant);
+        store_merge_epi32_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier = _mm256_broadcastsi128_si256(t->multiplier);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epu32_si256(in + i, &even, &odd);
+        even = cl_fastquadratic32_si256(even, multiplier, constant);
+        odd = cl_fastquadratic32_si256(odd, multiplier, constant);
+        store_merge_epi32_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_fastquadratic32(in[i], t);
+    }
+}
+
 /***
 * Follows a 64-bit cubic hash
 **/
@@ -243,6 +936,71 @@ inline uint64_t cl_cubic(uint64_t x, const cl_cubic_t *t) {
     return _mm_cvtsi128_si64(answer);
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_cubic_si512(__m512i x, __m512i multiplier1,
+                                     __m512i multiplier2, __m512i constant) {
+    __m512i inputsquare =
+        reduction64_si512(_mm512_clmulepi64_epi128(x, x, 0x00));
+    __m512i inputcube =
+        reduction64_si512(_mm512_clmulepi64_epi128(inputsquare, x, 0x00));
+    __m512i product1 = _mm512_clmulepi64_epi128(x, multiplier1, 0x00);
+    __m512i product2 = _mm512_clmulepi64_epi128(inputsquare, multiplier1, 0x10);
+    __m512i product3 = _mm512_clmulepi64_epi128(inputcube, multiplier2, 0x00);
+    __m512i sum1 = _mm512_xor_si512(product1, constant);
+    __m512i sum2 = _mm512_xor_si512(product2, product3);
+    return reduction64_si512(_mm512_xor_si512(sum1, sum2));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_cubic_si256(__m256i x, __m256i multiplier1,
+                                     __m256i multiplier2, __m256i constant) {
+    __m256i inputsquare =
+        reduction64_si256(_mm256_clmulepi64_epi128(x, x, 0x00));
+    __m256i inputcube =
+        reduction64_si256(_mm256_clmulepi64_epi128(inputsquare, x, 0x00));
+    __m256i product1 = _mm256_clmulepi64_epi128(x, multiplier1, 0x00);
+    __m256i product2 = _mm256_clmulepi64_epi128(inputsquare, multiplier1, 0x10);
+    __m256i product3 = _mm256_clmulepi64_epi128(inputcube, multiplier2, 0x00);
+    __m256i sum1 = _mm256_xor_si256(product1, constant);
+    __m256i sum2 = _mm256_xor_si256(product2, product3);
+    return reduction64_si256(_mm256_xor_si256(sum1, sum2));
+}
+#endif
+
+void cl_cubic_batch(const uint64_t *in, uint64_t *out, size_t n,
+                    const cl_cubic_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier1 = _mm512_broadcast_i32x4(t->multiplier1);
+    const __m512i multiplier2 = _mm512_broadcast_i32x4(t->multiplier2);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = cl_cubic_si512(even, multiplier1, multiplier2, constant);
+        odd = cl_cubic_si512(odd, multiplier1, multiplier2, constant);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier1 = _mm256_broadcastsi128_si256(t->multiplier1);
+    const __m256i multiplier2 = _mm256_broadcastsi128_si256(t->multiplier2);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = cl_cubic_si256(even, multiplier1, multiplier2, constant);
+        odd = cl_cubic_si256(odd, multiplier1, multiplier2, constant);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_cubic(in[i], t);
+    }
+}
+
 
 
 /***
@@ -286,4 +1044,79 @@ inline uint64_t cl_quartic(uint64_t x, const cl_quartic_t *t) {
     return _mm_cvtsi128_si64(answer);
 }
 
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i cl_quartic_si512(__m512i x, __m512i multiplier1,
+                                       __m512i multiplier2, __m512i constant) {
+    __m512i inputsquare =
+        reduction64_si512(_mm512_clmulepi64_epi128(x, x, 0x00));
+    __m512i inputcube =
+        reduction64_si512(_mm512_clmulepi64_epi128(inputsquare, x, 0x00));
+    __m512i inputquartic = reduction64_si512(
+        _mm512_clmulepi64_epi128(inputsquare, inputsquare, 0x00));
+    __m512i product1 = _mm512_clmulepi64_epi128(x, multiplier1, 0x00);
+    __m512i product2 = _mm512_clmulepi64_epi128(inputsquare, multiplier1, 0x10);
+    __m512i product3 = _mm512_clmulepi64_epi128(inputcube, multiplier2, 0x00);
+    __m512i product4 =
+        _mm512_clmulepi64_epi128(inputquartic, multiplier2, 0x10);
+    __m512i sum1 = _mm512_xor_si512(product1, constant);
+    __m512i sum2 = _mm512_xor_si512(product2, product3);
+    __m512i sum = _mm512_xor_si512(product4, _mm512_xor_si512(sum1, sum2));
+    return reduction64_si512(sum);
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i cl_quartic_si256(__m256i x, __m256i multiplier1,
+                                       __m256i multiplier2, __m256i constant) {
+    __m256i inputsquare =
+        reduction64_si256(_mm256_clmulepi64_epi128(x, x, 0x00));
+    __m256i inputcube =
+        reduction64_si256(_mm256_clmulepi64_epi128(inputsquare, x, 0x00));
+    __m256i inputquartic = reduction64_si256(
+        _mm256_clmulepi64_epi128(inputsquare, inputsquare, 0x00));
+    __m256i product1 = _mm256_clmulepi64_epi128(x, multiplier1, 0x00);
+    __m256i product2 = _mm256_clmulepi64_epi128(inputsquare, multiplier1, 0x10);
+    __m256i product3 = _mm256_clmulepi64_epi128(inputcube, multiplier2, 0x00);
+    __m256i product4 =
+        _mm256_clmulepi64_epi128(inputquartic, multiplier2, 0x10);
+    __m256i sum1 = _mm256_xor_si256(product1, constant);
+    __m256i sum2 = _mm256_xor_si256(product2, product3);
+    __m256i sum = _mm256_xor_si256(product4, _mm256_xor_si256(sum1, sum2));
+    return reduction64_si256(sum);
+}
+#endif
+
+void cl_quartic_batch(const uint64_t *in, uint64_t *out, size_t n,
+                      const cl_quartic_t *t) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i multiplier1 = _mm512_broadcast_i32x4(t->multiplier1);
+    const __m512i multiplier2 = _mm512_broadcast_i32x4(t->multiplier2);
+    const __m512i constant = _mm512_broadcast_i32x4(t->constant);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        even = cl_quartic_si512(even, multiplier1, multiplier2, constant);
+        odd = cl_quartic_si512(odd, multiplier1, multiplier2, constant);
+        store_merge_epi64_si512(out + i, even, odd);
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i multiplier1 = _mm256_broadcastsi128_si256(t->multiplier1);
+    const __m256i multiplier2 = _mm256_broadcastsi128_si256(t->multiplier2);
+    const __m256i constant = _mm256_broadcastsi128_si256(t->constant);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        even = cl_quartic_si256(even, multiplier1, multiplier2, constant);
+        odd = cl_quartic_si256(odd, multiplier1, multiplier2, constant);
+        store_merge_epi64_si256(out + i, even, odd);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cl_quartic(in[i], t);
+    }
+}
+
 #endif
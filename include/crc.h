@@ -1,6 +1,7 @@
 #ifndef CRC_H
 #define CRC_H
 
+#include <stddef.h>
 #include <nmmintrin.h> // x86 intrinsics
 
 
@@ -22,4 +23,49 @@ inline uint32_t CRC32(uint32_t in, const CRCRandomness *rand) {
     return _mm_crc32_u32(rand->crcseed,in);
 }
 
+// The keys do not depend on each other, so the core already overlaps the
+// crc32s of consecutive iterations: a plain loop is enough.
+void CRC32_64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                   const CRCRandomness *rand) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = CRC32_64(in[i], rand);
+    }
+}
+
+void CRC32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                const CRCRandomness *rand) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = CRC32(in[i], rand);
+    }
+}
+
+/**
+* A 64-bit hash value from two seeded CRC32s. The CRCs of one input under two
+* seeds only differ by a constant, so the high half hashes in ^ (in >> 32)
+* instead: the two halves together are then an invertible (affine) map of in.
+*/
+typedef struct {
+  uint32_t crcseed1;
+  uint32_t crcseed2;
+} CRCWideRandomness;
+
+void CRCWideInit(CRCWideRandomness *x) {
+  x->crcseed1 = get32rand();
+  x->crcseed2 = get32rand();
+}
+
+__attribute__((always_inline))
+inline uint64_t CRCWide64(uint64_t in, const CRCWideRandomness *rand) {
+    const uint64_t lo = _mm_crc32_u64(rand->crcseed1, in);
+    const uint64_t hi = _mm_crc32_u64(rand->crcseed2, in ^ (in >> 32));
+    return lo | (hi << 32);
+}
+
+void CRCWide64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                    const CRCWideRandomness *rand) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = CRCWide64(in[i], rand);
+    }
+}
+
 #endif
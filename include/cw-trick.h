@@ -1,6 +1,7 @@
 #ifndef SHORTHASH_CW_TRICK_H
 #define SHORTHASH_CW_TRICK_H
 
+#include "simd.h"
 #include "util.h"
 
 const uint8_t CW_PRIME_POWER = 61;
@@ -33,6 +34,60 @@ inline uint32_t CWQuad32(uint32_t x, const CWRandomQuad32 * r) {
     //  (a*x + b)*x + c
 }
 
+/* CWQuad32 on each 64-bit lane, x holding a 32-bit key in its low half. The
+97-bit (a*x + b)*x + c is t 2^32 + s_lo with t < 2^64, and the low 32 bits of
+cwmod are those of s_lo + (t >> 29). */
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i CWQuad32_si512(__m512i x, __m512i a, __m512i b, __m512i c) {
+    const __m512i axb = _mm512_add_epi64(_mm512_mul_epu32(a, x), b); // < 2^64
+    const __m512i s = _mm512_add_epi64(_mm512_mul_epu32(axb, x), c);
+    const __m512i t = _mm512_add_epi64(
+        _mm512_mul_epu32(_mm512_srli_epi64(axb, 32), x), _mm512_srli_epi64(s, 32));
+    return _mm512_add_epi64(s, _mm512_srli_epi64(t, 29));
+}
+#endif
+
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline __m256i CWQuad32_si256(__m256i x, __m256i a, __m256i b, __m256i c) {
+    const __m256i axb = _mm256_add_epi64(_mm256_mul_epu32(a, x), b);
+    const __m256i s = _mm256_add_epi64(_mm256_mul_epu32(axb, x), c);
+    const __m256i t = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(axb, 32), x), _mm256_srli_epi64(s, 32));
+    return _mm256_add_epi64(s, _mm256_srli_epi64(t, 29));
+}
+#endif
+
+void CWQuad32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                   const CWRandomQuad32 *r) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i a = _mm512_set1_epi64(r->a);
+    const __m512i b = _mm512_set1_epi64(r->b);
+    const __m512i c = _mm512_set1_epi64(r->c);
+    for (; i + 16 <= n; i += 16) {
+        __m512i even, odd;
+        load_even_odd_epu32_si512(in + i, &even, &odd);
+        store_even_odd_epu32_si512(out + i, CWQuad32_si512(even, a, b, c),
+                                   CWQuad32_si512(odd, a, b, c));
+    }
+#elif defined(__AVX2__)
+    const __m256i a = _mm256_set1_epi64x(r->a);
+    const __m256i b = _mm256_set1_epi64x(r->b);
+    const __m256i c = _mm256_set1_epi64x(r->c);
+    for (; i + 8 <= n; i += 8) {
+        __m256i even, odd;
+        load_even_odd_epu32_si256(in + i, &even, &odd);
+        store_even_odd_epu32_si256(out + i, CWQuad32_si256(even, a, b, c),
+                                   CWQuad32_si256(odd, a, b, c));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = CWQuad32(in[i], r);
+    }
+}
+
 
 
 
@@ -82,23 +137,23 @@ typedef struct ThorupZhangCWCubic32_s {
 } ThorupZhangCWCubic32_t;
 
 void ThorupZhangCWLinear32Init(ThorupZhangCWLinear32_t * k) {
-    k->A=get64rand();
-    k->B=get64rand();
+    k->A=get64rand()&Prime61;
+    k->B=get64rand()&Prime61;
 }
 
 
 void ThorupZhangCWQuadratic32Init(ThorupZhangCWQuadratic32_t * k) {
-    k->A=get64rand();
-    k->B=get64rand();
-    k->C=get64rand();
+    k->A=get64rand()&Prime61;
+    k->B=get64rand()&Prime61;
+    k->C=get64rand()&Prime61;
 }
 
 
 void ThorupZhangCWCubic32Init(ThorupZhangCWCubic32_t * k) {
-    k->A=get64rand();
-    k->B=get64rand();
-    k->C=get64rand();
-    k->D=get64rand();
+    k->A=get64rand()&Prime61;
+    k->B=get64rand()&Prime61;
+    k->C=get64rand()&Prime61;
+    k->D=get64rand()&Prime61;
 }
 
 /* CWtrick for 32-bit key x with prime 2ˆ61-1 */
@@ -115,7 +170,7 @@ inline uint32_t ThorupZhangCWLinear32(uint32_t x, const ThorupZhangCWLinear32_t
 __attribute__((always_inline))
 inline uint32_t ThorupZhangCWQuadratic32(uint32_t x, const ThorupZhangCWQuadratic32_t * k) {
     uint64_t h;
-    h = MultAddPrime61(MultAddPrime61(x,k->A,k->B),x,k->C);
+    h = MultAddPrime61(x,MultAddPrime61(x,k->A,k->B),k->C);
     h = (h&Prime61)+(h>>61);
     if (h>=Prime61) h-=Prime61;
     return h;
@@ -125,12 +180,305 @@ inline uint32_t ThorupZhangCWQuadratic32(uint32_t x, const ThorupZhangCWQuadrati
 __attribute__((always_inline))
 inline uint32_t ThorupZhangCWCubic32(uint32_t x, const ThorupZhangCWCubic32_t * k) {
     uint64_t h;
-    h = MultAddPrime61(MultAddPrime61(MultAddPrime61(x,k->A,k->B),x,k->C),x,k->D);
+    h = MultAddPrime61(x,MultAddPrime61(x,MultAddPrime61(x,k->A,k->B),k->C),k->D);
+    h = (h&Prime61)+(h>>61);
+    if (h>=Prime61) h-=Prime61;
+    return h;
+}
+
+/* MultAddPrime61 on each 64-bit lane, x holding zero-extended 32-bit keys */
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i MultAddPrime61_si512(__m512i x, __m512i a, __m512i b) {
+    const __m512i a0 = _mm512_mul_epu32(a, x);
+    const __m512i a1 = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), x);
+    const __m512i c0 = _mm512_add_epi64(a0, _mm512_slli_epi64(a1, 32));
+    const __m512i c1 = _mm512_add_epi64(_mm512_srli_epi64(a0, 32), a1);
+    const __m512i c = _mm512_add_epi64(
+        _mm512_and_si512(c0, _mm512_set1_epi64(Prime61)), _mm512_srli_epi64(c1, 29));
+    return _mm512_add_epi64(c, b);
+}
+
+/* h mod Prime61 for h < 2^64 */
+__attribute__((always_inline))
+static inline __m512i ModPrime61_si512(__m512i h) {
+    const __m512i prime = _mm512_set1_epi64(Prime61);
+    h = _mm512_add_epi64(_mm512_and_si512(h, prime), _mm512_srli_epi64(h, 61));
+    // h >= Prime61 iff h + 1 >= 2^61, and then h - Prime61 = (h + 1) & Prime61
+    const __m512i carry =
+        _mm512_srli_epi64(_mm512_add_epi64(h, _mm512_set1_epi64(1)), 61);
+    return _mm512_and_si512(_mm512_add_epi64(h, carry), prime);
+}
+#endif
+
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline __m256i MultAddPrime61_si256(__m256i x, __m256i a, __m256i b) {
+    const __m256i a0 = _mm256_mul_epu32(a, x);
+    const __m256i a1 = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), x);
+    const __m256i c0 = _mm256_add_epi64(a0, _mm256_slli_epi64(a1, 32));
+    const __m256i c1 = _mm256_add_epi64(_mm256_srli_epi64(a0, 32), a1);
+    const __m256i c = _mm256_add_epi64(
+        _mm256_and_si256(c0, _mm256_set1_epi64x(Prime61)), _mm256_srli_epi64(c1, 29));
+    return _mm256_add_epi64(c, b);
+}
+
+__attribute__((always_inline))
+static inline __m256i ModPrime61_si256(__m256i h) {
+    const __m256i prime = _mm256_set1_epi64x(Prime61);
+    h = _mm256_add_epi64(_mm256_and_si256(h, prime), _mm256_srli_epi64(h, 61));
+    const __m256i carry =
+        _mm256_srli_epi64(_mm256_add_epi64(h, _mm256_set1_epi64x(1)), 61);
+    return _mm256_and_si256(_mm256_add_epi64(h, carry), prime);
+}
+#endif
+
+/* Batch Horner evaluation of coeffs[0] x^(count-1) + ... + coeffs[count-1]
+modulo Prime61 (count <= 4), truncated to 32 bits like ThorupZhangCW*32.
+Returns how many keys were hashed; the caller finishes the tail. */
+__attribute__((always_inline))
+static inline size_t HornerPrime61Batch(const uint32_t *in, uint32_t *out,
+                                        size_t n, const uint64_t *coeffs,
+                                        int count) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    __m512i k[4];
+    for (int j = 0; j < count; ++j) {
+        k[j] = _mm512_set1_epi64(coeffs[j]);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512i even, odd;
+        load_even_odd_epu32_si512(in + i, &even, &odd);
+        __m512i he = k[0], ho = k[0];
+        for (int j = 1; j < count; ++j) {
+            he = MultAddPrime61_si512(even, he, k[j]);
+            ho = MultAddPrime61_si512(odd, ho, k[j]);
+        }
+        store_even_odd_epu32_si512(out + i, ModPrime61_si512(he),
+                                   ModPrime61_si512(ho));
+    }
+#elif defined(__AVX2__)
+    __m256i k[4];
+    for (int j = 0; j < count; ++j) {
+        k[j] = _mm256_set1_epi64x(coeffs[j]);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256i even, odd;
+        load_even_odd_epu32_si256(in + i, &even, &odd);
+        __m256i he = k[0], ho = k[0];
+        for (int j = 1; j < count; ++j) {
+            he = MultAddPrime61_si256(even, he, k[j]);
+            ho = MultAddPrime61_si256(odd, ho, k[j]);
+        }
+        store_even_odd_epu32_si256(out + i, ModPrime61_si256(he),
+                                   ModPrime61_si256(ho));
+    }
+#else
+    (void)in; (void)out; (void)n; (void)coeffs; (void)count;
+#endif
+    return i;
+}
+
+void ThorupZhangCWLinear32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                                const ThorupZhangCWLinear32_t *k) {
+    const uint64_t coeffs[2] = {k->A, k->B};
+    size_t i = HornerPrime61Batch(in, out, n, coeffs, 2);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWLinear32(in[i], k);
+    }
+}
+
+void ThorupZhangCWQuadratic32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                                   const ThorupZhangCWQuadratic32_t *k) {
+    const uint64_t coeffs[3] = {k->A, k->B, k->C};
+    size_t i = HornerPrime61Batch(in, out, n, coeffs, 3);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWQuadratic32(in[i], k);
+    }
+}
+
+void ThorupZhangCWCubic32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                               const ThorupZhangCWCubic32_t *k) {
+    const uint64_t coeffs[4] = {k->A, k->B, k->C, k->D};
+    size_t i = HornerPrime61Batch(in, out, n, coeffs, 4);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWCubic32(in[i], k);
+    }
+}
+
+/* coeffs[0] x^(count-1) + ... + coeffs[count-1] modulo Prime61, fully
+reduced, the way ThorupZhangCW*32 computes it */
+static inline uint64_t HornerPrime61(uint32_t x, const uint64_t *coeffs,
+                                     int count) {
+    uint64_t h = coeffs[0];
+    for (int j = 1; j < count; ++j) {
+        h = MultAddPrime61(x, h, coeffs[j]);
+    }
     h = (h&Prime61)+(h>>61);
     if (h>=Prime61) h-=Prime61;
     return h;
 }
 
+/* (a + b) mod Prime61 for a, b < Prime61: a + b >= Prime61 iff a + b + 1
+carries into bit 61, and then a + b - Prime61 is a + b + 1 without it */
+static inline uint64_t AddPrime61(uint64_t a, uint64_t b) {
+    const uint64_t s = a + b;
+    return (s + ((s + 1) >> 61)) & Prime61;
+}
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i AddPrime61_si512(__m512i a, __m512i b) {
+    const __m512i s = _mm512_add_epi64(a, b);
+    const __m512i carry =
+        _mm512_srli_epi64(_mm512_add_epi64(s, _mm512_set1_epi64(1)), 61);
+    return _mm512_and_si512(_mm512_add_epi64(s, carry), _mm512_set1_epi64(Prime61));
+}
+#endif
+
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline __m256i AddPrime61_si256(__m256i a, __m256i b) {
+    const __m256i s = _mm256_add_epi64(a, b);
+    const __m256i carry =
+        _mm256_srli_epi64(_mm256_add_epi64(s, _mm256_set1_epi64x(1)), 61);
+    return _mm256_and_si256(_mm256_add_epi64(s, carry), _mm256_set1_epi64x(Prime61));
+}
+#endif
+
+/* Turns the values v[0..degree] of a polynomial of degree at most degree at
+x, x + d, ... into its forward differences at x, modulo Prime61 */
+static inline void ForwardDifferencesPrime61(uint64_t *v, int degree) {
+    for (int k = 1; k <= degree; ++k) {
+        for (int t = degree; t >= k; --t) {
+            v[t] = AddPrime61(v[t], Prime61 - v[t - 1]);
+        }
+    }
+}
+
+/* Range version of HornerPrime61Batch. A polynomial of degree d is advanced
+by its finite differences: d additions modulo Prime61 per key, once the
+differences are set up (d + 1 Horner evaluations) at the start of every run
+of keys that does not wrap around 2^32. Runs shorter than 256 keys go
+through the batch kernel instead. As in the batch kernels, the lanes hold
+the even and the odd keys. */
+static inline void HornerPrime61Range(uint32_t start, uint32_t stride,
+                                      size_t n, uint32_t *out,
+                                      const uint64_t *coeffs, int count) {
+    const int degree = count - 1;
+    for (size_t i = 0; i < n;) {
+        const size_t m = range_nowrap32(start, stride, n - i);
+        size_t k = 0;
+        if (m < 256) {
+            // too short to pay for setting up the differences
+            for (; k < m; ++k) {
+                out[i + k] = start + (uint32_t)k * stride;
+            }
+            for (k = HornerPrime61Batch(out + i, out + i, m, coeffs, count);
+                 k < m; ++k) {
+                out[i + k] = (uint32_t)HornerPrime61(out[i + k], coeffs, count);
+            }
+        }
+#if defined(__AVX512F__) || defined(__AVX2__)
+#if defined(__AVX512F__)
+        const int lanes = 16;
+#else
+        const int lanes = 8;
+#endif
+        if (m >= 256) {
+            // the first lanes * count keys by one-lane differences, then
+            // the differences of each lane, in steps of lanes keys
+            uint64_t v[4], first[64], diff[4][16];
+            for (int t = 0; t <= degree; ++t) {
+                v[t] = HornerPrime61(start + (uint32_t)t * stride, coeffs, count);
+            }
+            ForwardDifferencesPrime61(v, degree);
+            for (int q = 0; q < lanes * count; ++q) {
+                first[q] = v[0];
+                for (int t = 0; t < degree; ++t) {
+                    v[t] = AddPrime61(v[t], v[t + 1]);
+                }
+            }
+            for (int j = 0; j < lanes; ++j) {
+                for (int t = 0; t <= degree; ++t) {
+                    v[t] = first[j + lanes * t];
+                }
+                ForwardDifferencesPrime61(v, degree);
+                for (int t = 0; t <= degree; ++t) {
+                    diff[t][(j & 1) * lanes / 2 + j / 2] = v[t];
+                }
+            }
+#if defined(__AVX512F__)
+            __m512i even[4], odd[4];
+            for (int t = 0; t <= degree; ++t) {
+                even[t] = _mm512_loadu_si512(diff[t]);
+                odd[t] = _mm512_loadu_si512(diff[t] + 8);
+            }
+            for (; k + 16 <= m; k += 16) {
+                store_even_odd_epu32_si512(out + i + k, even[0], odd[0]);
+                for (int t = 0; t < degree; ++t) {
+                    even[t] = AddPrime61_si512(even[t], even[t + 1]);
+                    odd[t] = AddPrime61_si512(odd[t], odd[t + 1]);
+                }
+            }
+#else
+            __m256i even[4], odd[4];
+            for (int t = 0; t <= degree; ++t) {
+                even[t] = _mm256_loadu_si256((const __m256i *)diff[t]);
+                odd[t] = _mm256_loadu_si256((const __m256i *)(diff[t] + 4));
+            }
+            for (; k + 8 <= m; k += 8) {
+                store_even_odd_epu32_si256(out + i + k, even[0], odd[0]);
+                for (int t = 0; t < degree; ++t) {
+                    even[t] = AddPrime61_si256(even[t], even[t + 1]);
+                    odd[t] = AddPrime61_si256(odd[t], odd[t + 1]);
+                }
+            }
+#endif
+        }
+#endif
+        if (m - k > (size_t)count) {
+            uint64_t v[4];
+            for (int t = 0; t <= degree; ++t) {
+                v[t] = HornerPrime61(start + (uint32_t)(k + t) * stride, coeffs,
+                                     count);
+            }
+            ForwardDifferencesPrime61(v, degree);
+            for (; k < m; ++k) {
+                out[i + k] = (uint32_t)v[0];
+                for (int t = 0; t < degree; ++t) {
+                    v[t] = AddPrime61(v[t], v[t + 1]);
+                }
+            }
+        }
+        for (; k < m; ++k) {
+            out[i + k] = (uint32_t)HornerPrime61(start + (uint32_t)k * stride,
+                                                 coeffs, count);
+        }
+        start += (uint32_t)m * stride;
+        i += m;
+    }
+}
+
+void ThorupZhangCWLinear32Range(uint32_t start, uint32_t stride, size_t n,
+                                uint32_t *out, const ThorupZhangCWLinear32_t *k) {
+    const uint64_t coeffs[2] = {k->A, k->B};
+    HornerPrime61Range(start, stride, n, out, coeffs, 2);
+}
+
+void ThorupZhangCWQuadratic32Range(uint32_t start, uint32_t stride, size_t n,
+                                   uint32_t *out,
+                                   const ThorupZhangCWQuadratic32_t *k) {
+    const uint64_t coeffs[3] = {k->A, k->B, k->C};
+    HornerPrime61Range(start, stride, n, out, coeffs, 3);
+}
+
+void ThorupZhangCWCubic32Range(uint32_t start, uint32_t stride, size_t n,
+                               uint32_t *out, const ThorupZhangCWCubic32_t *k) {
+    const uint64_t coeffs[4] = {k->A, k->B, k->C, k->D};
+    HornerPrime61Range(start, stride, n, out, coeffs, 4);
+}
+
 const static uint64_t Prime89_0 = (((uint64_t)1)<<32)-1;
 const static uint64_t Prime89_1 = (((uint64_t)1)<<32)-1;
 const static uint64_t Prime89_2 = (((uint64_t)1)<<25)-1;
@@ -177,6 +525,13 @@ static inline void MultAddPrime89(INT96 r, uint64_t x, const INT96 a, const INT9
     carry = HIGH(s1);
     r[2] = b[2] + HIGH(d2) + d3 + carry;
 }
+/* Random r < 2^89, with limbs as MultAddPrime89 expects them. */
+static inline void RandomINT96(INT96 r) {
+    r[0] = get32rand();
+    r[1] = get32rand();
+    r[2] = get32rand()&Prime89_2;
+}
+
 typedef struct ThorupZhangCWLinear64_s {
     INT96 A;
     INT96 B;
@@ -197,30 +552,24 @@ typedef struct ThorupZhangCWCubic64_s {
 
 __attribute__((always_inline))
 inline void ThorupZhangCWLinear64Init(ThorupZhangCWLinear64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A[i]=get64rand();
-        k->B[i]=get64rand();
-    }
+    RandomINT96(k->A);
+    RandomINT96(k->B);
 }
 
 __attribute__((always_inline))
 inline void ThorupZhangCWQuadratic64Init(ThorupZhangCWQuadratic64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A[i]=get64rand();
-        k->B[i]=get64rand();
-        k->C[i]=get64rand();
-    }
+    RandomINT96(k->A);
+    RandomINT96(k->B);
+    RandomINT96(k->C);
 }
 
 
 __attribute__((always_inline))
 inline void ThorupZhangCWCubic64Init(ThorupZhangCWCubic64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A[i]=get64rand();
-        k->B[i]=get64rand();
-        k->C[i]=get64rand();
-        k->D[i]=get64rand();
-    }
+    RandomINT96(k->A);
+    RandomINT96(k->B);
+    RandomINT96(k->C);
+    RandomINT96(k->D);
 }
 
 
@@ -254,5 +603,185 @@ inline uint64_t ThorupZhangCWCubic64(uint64_t x, const ThorupZhangCWCubic64_t *
 }
 
 
+/* r as a single integer */
+static inline uint128_t INT96Value(const INT96 r) {
+    return ((uint128_t)r[2] << 64) + (r[1] << 32) + r[0];
+}
+
+#if defined(__AVX512IFMA__)
+/* The IFMA engine keeps h = h0 + h1 2^52 with h0 < 2^52 and h1 < 2^38, and
+splits the key as x = x0 + x1 2^52. Computes h x + b modulo Prime89 (not
+fully reduced, same bounds) with seven 52-bit multiply-adds. */
+__attribute__((always_inline))
+static inline void MultAddPrime89_si512(__m512i *h0, __m512i *h1, __m512i x0,
+                                        __m512i x1, __m512i b0, __m512i b1) {
+    const __m512i mask52 = _mm512_set1_epi64((UINT64_C(1) << 52) - 1);
+    const __m512i mask37 = _mm512_set1_epi64((UINT64_C(1) << 37) - 1);
+    // h x + b = c0 + c1 2^52 + c2 2^104
+    const __m512i c0 = _mm512_madd52lo_epu64(b0, *h0, x0);
+    __m512i c1 = _mm512_madd52hi_epu64(b1, *h0, x0);
+    c1 = _mm512_madd52lo_epu64(c1, *h0, x1);
+    c1 = _mm512_madd52lo_epu64(c1, *h1, x0);
+    __m512i c2 = _mm512_madd52hi_epu64(_mm512_setzero_si512(), *h0, x1);
+    c2 = _mm512_madd52hi_epu64(c2, *h1, x0);
+    c2 = _mm512_madd52lo_epu64(c2, *h1, x1);
+    // 2^89 = 1 and 2^104 = 2^15 modulo Prime89
+    const __m512i t0 = _mm512_add_epi64(
+        _mm512_add_epi64(c0, _mm512_srli_epi64(c1, 37)),
+        _mm512_and_si512(_mm512_slli_epi64(c2, 15), mask52));
+    *h1 = _mm512_add_epi64(
+        _mm512_add_epi64(_mm512_and_si512(c1, mask37), _mm512_srli_epi64(c2, 37)),
+        _mm512_srli_epi64(t0, 52));
+    *h0 = _mm512_and_si512(t0, mask52);
+}
+
+/* (h mod Prime89) mod 2^64 */
+__attribute__((always_inline))
+static inline __m512i Mod64Prime89_si512(__m512i h0, __m512i h1) {
+    const __m512i mask52 = _mm512_set1_epi64((UINT64_C(1) << 52) - 1);
+    const __m512i mask37 = _mm512_set1_epi64((UINT64_C(1) << 37) - 1);
+    // fold the bits from 89 up, leaving h < 2^89 + 2^52 < 2 Prime89
+    h0 = _mm512_add_epi64(h0, _mm512_srli_epi64(h1, 37));
+    h1 = _mm512_add_epi64(_mm512_and_si512(h1, mask37), _mm512_srli_epi64(h0, 52));
+    h0 = _mm512_and_si512(h0, mask52);
+    // h >= Prime89 iff h + 1 >= 2^89, and then h - Prime89 = h + 1 - 2^89
+    const __m512i carry = _mm512_srli_epi64(
+        _mm512_add_epi64(h1, _mm512_srli_epi64(
+                                 _mm512_add_epi64(h0, _mm512_set1_epi64(1)), 52)),
+        37);
+    return _mm512_add_epi64(_mm512_add_epi64(h0, _mm512_slli_epi64(h1, 52)), carry);
+}
+#elif defined(__AVX2__)
+/* MultAddPrime89 on each 64-bit lane, with the same 32-bit limbs */
+__attribute__((always_inline))
+static inline void MultAddPrime89_si256(__m256i *r0, __m256i *r1, __m256i *r2,
+                                        __m256i x, __m256i b0, __m256i b1,
+                                        __m256i b2) {
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i x1 = _mm256_srli_epi64(x, 32);
+    const __m256i c21 = _mm256_mul_epu32(*r2, x1);
+    const __m256i c11 = _mm256_mul_epu32(*r1, x1);
+    const __m256i c01 = _mm256_mul_epu32(*r0, x1);
+    const __m256i c20 = _mm256_mul_epu32(*r2, x);
+    const __m256i c10 = _mm256_mul_epu32(*r1, x);
+    const __m256i c00 = _mm256_mul_epu32(*r0, x);
+    const __m256i d0 = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_srli_epi64(c20, 25), _mm256_srli_epi64(c11, 25)),
+        _mm256_add_epi64(_mm256_srli_epi64(c10, 57), _mm256_srli_epi64(c01, 57)));
+    const __m256i d1 = _mm256_slli_epi64(c21, 7);
+    const __m256i p21 = _mm256_set1_epi64x(Prime89_21);
+    const __m256i d2 = _mm256_add_epi64(_mm256_and_si256(c10, p21),
+                                        _mm256_and_si256(c01, p21));
+    const __m256i p2 = _mm256_set1_epi64x(Prime89_2);
+    const __m256i d3 = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_and_si256(c20, p2), _mm256_and_si256(c11, p2)),
+        _mm256_srli_epi64(c21, 57));
+    const __m256i s0 = _mm256_add_epi64(
+        _mm256_add_epi64(b0, _mm256_and_si256(c00, low)),
+        _mm256_add_epi64(_mm256_and_si256(d0, low), _mm256_and_si256(d1, low)));
+    const __m256i s1 = _mm256_add_epi64(
+        _mm256_add_epi64(
+            _mm256_add_epi64(b1, _mm256_srli_epi64(c00, 32)),
+            _mm256_add_epi64(_mm256_srli_epi64(d0, 32), _mm256_srli_epi64(d1, 32))),
+        _mm256_add_epi64(_mm256_and_si256(d2, low), _mm256_srli_epi64(s0, 32)));
+    *r0 = _mm256_and_si256(s0, low);
+    *r1 = _mm256_and_si256(s1, low);
+    *r2 = _mm256_add_epi64(
+        _mm256_add_epi64(b2, _mm256_srli_epi64(d2, 32)),
+        _mm256_add_epi64(d3, _mm256_srli_epi64(s1, 32)));
+}
+
+/* Mod64Prime89 on each 64-bit lane */
+__attribute__((always_inline))
+static inline __m256i Mod64Prime89_si256(__m256i r0, __m256i r1, __m256i r2) {
+    r0 = _mm256_add_epi64(r0, _mm256_srli_epi64(r2, 25));
+    r2 = _mm256_and_si256(r2, _mm256_set1_epi64x(Prime89_2));
+    // the limbs are small enough for the signed comparisons
+    const __m256i top = _mm256_and_si256(
+        _mm256_cmpeq_epi64(r2, _mm256_set1_epi64x(Prime89_2)),
+        _mm256_cmpeq_epi64(r1, _mm256_set1_epi64x(Prime89_1)));
+    const __m256i over = _mm256_and_si256(
+        top, _mm256_cmpgt_epi64(r0, _mm256_set1_epi64x(Prime89_0 - 1)));
+    return _mm256_blendv_epi8(
+        _mm256_add_epi64(r0, _mm256_slli_epi64(r1, 32)),
+        _mm256_sub_epi64(r0, _mm256_set1_epi64x(Prime89_0)), over);
+}
+#endif
+
+/* Batch Horner evaluation of coeffs[0] x^(count-1) + ... + coeffs[count-1]
+modulo Prime89 (count <= 4, coefficients below 2^89), truncated to 64 bits.
+This is exactly what ThorupZhangCW*64 and FasterCW*64 compute. Returns how
+many keys were hashed; the caller finishes the tail. */
+__attribute__((always_inline))
+static inline size_t HornerPrime89Batch(const uint64_t *in, uint64_t *out,
+                                        size_t n, const uint128_t *coeffs,
+                                        int count) {
+    size_t i = 0;
+#if defined(__AVX512IFMA__)
+    const __m512i mask52 = _mm512_set1_epi64((UINT64_C(1) << 52) - 1);
+    __m512i k0[4], k1[4];
+    for (int j = 0; j < count; ++j) {
+        k0[j] = _mm512_set1_epi64((uint64_t)coeffs[j] & ((UINT64_C(1) << 52) - 1));
+        k1[j] = _mm512_set1_epi64((uint64_t)(coeffs[j] >> 52));
+    }
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        const __m512i x0 = _mm512_and_si512(x, mask52);
+        const __m512i x1 = _mm512_srli_epi64(x, 52);
+        __m512i h0 = k0[0], h1 = k1[0];
+        for (int j = 1; j < count; ++j) {
+            MultAddPrime89_si512(&h0, &h1, x0, x1, k0[j], k1[j]);
+        }
+        _mm512_storeu_si512(out + i, Mod64Prime89_si512(h0, h1));
+    }
+#elif defined(__AVX2__)
+    __m256i k0[4], k1[4], k2[4];
+    for (int j = 0; j < count; ++j) {
+        k0[j] = _mm256_set1_epi64x(LOW((uint64_t)coeffs[j]));
+        k1[j] = _mm256_set1_epi64x(HIGH((uint64_t)coeffs[j]));
+        k2[j] = _mm256_set1_epi64x((uint64_t)(coeffs[j] >> 64));
+    }
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i r0 = k0[0], r1 = k1[0], r2 = k2[0];
+        for (int j = 1; j < count; ++j) {
+            MultAddPrime89_si256(&r0, &r1, &r2, x, k0[j], k1[j], k2[j]);
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), Mod64Prime89_si256(r0, r1, r2));
+    }
+#else
+    (void)in; (void)out; (void)n; (void)coeffs; (void)count;
+#endif
+    return i;
+}
+
+void ThorupZhangCWLinear64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                                const ThorupZhangCWLinear64_t *k) {
+    const uint128_t coeffs[2] = {INT96Value(k->A), INT96Value(k->B)};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 2);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWLinear64(in[i], k);
+    }
+}
+
+void ThorupZhangCWQuadratic64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                                   const ThorupZhangCWQuadratic64_t *k) {
+    const uint128_t coeffs[3] = {INT96Value(k->A), INT96Value(k->B),
+                                 INT96Value(k->C)};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 3);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWQuadratic64(in[i], k);
+    }
+}
+
+void ThorupZhangCWCubic64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                               const ThorupZhangCWCubic64_t *k) {
+    const uint128_t coeffs[4] = {INT96Value(k->A), INT96Value(k->B),
+                                 INT96Value(k->C), INT96Value(k->D)};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 4);
+    for (; i < n; ++i) {
+        out[i] = ThorupZhangCWCubic64(in[i], k);
+    }
+}
 
 #endif
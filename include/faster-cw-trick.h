@@ -2,6 +2,7 @@
 #define SHORTHASH_FASTER_CW_TRICK_H
 
 
+#include "cw-trick.h"
 #include "util.h"
 
 /**
@@ -36,10 +37,10 @@ __uint128_t mersennemult(__uint128_t a, uint64_t x, __uint128_t b) {
   // so that a * x is smaller than 1<<(25+64)-1
   const int highpower = (89 - 64);//25
   const uint64_t highprime = (UINT64_C(1) << highpower ) -  1;
-  // we could almost do result += ((messy & highprime) + (messy >> highpower) )<< 64 but it might overflow!!!
+  // messy << 64 is (messy & highprime) << 64 plus (messy >> highpower) << 89,
+  // and 1 << 89 is 1 modulo the prime
   result +=  (messy & highprime) << 64  ;
-  messy = messy >> highpower ; // top 25 bits are zero
-  result += ( (messy & highprime)  + (messy >> highpower) ) << 64  ;
+  result += messy >> highpower ; // top 25 bits are zero
   // ok, now add the constant
   result += b;
   // next we compute the actual modulo
@@ -51,6 +52,11 @@ __uint128_t mersennemult(__uint128_t a, uint64_t x, __uint128_t b) {
 
 
 
+// random coefficient in [0,1<<89)
+static inline __uint128_t RandomPrime89Coefficient() {
+  return get128rand() & ((((__uint128_t)1) << 89) - 1);
+}
+
 typedef struct FasterCWLinear64_s {
     __uint128_t A;
     __uint128_t B;
@@ -71,30 +77,24 @@ typedef struct FasterCWCubic64_s {
 
 __attribute__((always_inline))
 inline void FasterCWLinear64Init(FasterCWLinear64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A=get64rand();
-        k->B=get64rand();
-    }
+    k->A=RandomPrime89Coefficient();
+    k->B=RandomPrime89Coefficient();
 }
 
 __attribute__((always_inline))
 inline void FasterCWQuadratic64Init(FasterCWQuadratic64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A=get64rand();
-        k->B=get64rand();
-        k->C=get64rand();
-    }
+    k->A=RandomPrime89Coefficient();
+    k->B=RandomPrime89Coefficient();
+    k->C=RandomPrime89Coefficient();
 }
 
 
 __attribute__((always_inline))
 inline void FasterCWCubic64Init(FasterCWCubic64_t * k) {
-    for(int i = 0; i < 3; ++i) {
-        k->A=get64rand();
-        k->B=get64rand();
-        k->C=get64rand();
-        k->D=get64rand();
-    }
+    k->A=RandomPrime89Coefficient();
+    k->B=RandomPrime89Coefficient();
+    k->C=RandomPrime89Coefficient();
+    k->D=RandomPrime89Coefficient();
 }
 
 
@@ -122,5 +122,259 @@ inline uint64_t FasterCWCubic64(uint64_t x, const FasterCWCubic64_t * k) {
 }
 
 
+void FasterCWLinear64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                           const FasterCWLinear64_t *k) {
+    const uint128_t coeffs[2] = {k->A, k->B};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 2);
+    for (; i < n; ++i) {
+        out[i] = FasterCWLinear64(in[i], k);
+    }
+}
+
+void FasterCWQuadratic64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                              const FasterCWQuadratic64_t *k) {
+    const uint128_t coeffs[3] = {k->A, k->B, k->C};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 3);
+    for (; i < n; ++i) {
+        out[i] = FasterCWQuadratic64(in[i], k);
+    }
+}
+
+void FasterCWCubic64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                          const FasterCWCubic64_t *k) {
+    const uint128_t coeffs[4] = {k->A, k->B, k->C, k->D};
+    size_t i = HornerPrime89Batch(in, out, n, coeffs, 4);
+    for (; i < n; ++i) {
+        out[i] = FasterCWCubic64(in[i], k);
+    }
+}
+
+/* The values of FasterCW*64 and ThorupZhangCW*64 before the truncation to
+64 bits: coeffs[0] x^(count-1) + ... + coeffs[count-1] modulo 2^89-1 */
+static inline __uint128_t HornerPrime89(uint64_t x, const __uint128_t *coeffs,
+                                        int count) {
+  __uint128_t h = coeffs[0];
+  for (int j = 1; j < count; ++j) {
+    h = mersennemult(h, x, coeffs[j]);
+  }
+  return h;
+}
+
+/* Additions modulo 2^89-1 on values kept as h0 + h1 2^52 with h0 < 2^52 and
+h1 < 2^37, like the IFMA engine of cw-trick.h: 64-bit adds, shifts and masks
+only. As for AddPrime61, a + b >= 2^89-1 iff a + b + 1 carries into bit 89. */
+static inline void AddPrime89Limbs(uint64_t *a0, uint64_t *a1, uint64_t b0,
+                                   uint64_t b1) {
+  const uint64_t mask52 = (UINT64_C(1) << 52) - 1;
+  const uint64_t mask37 = (UINT64_C(1) << 37) - 1;
+  uint64_t s0 = *a0 + b0;
+  uint64_t s1 = *a1 + b1 + (s0 >> 52);
+  s0 &= mask52;
+  const uint64_t over = (s1 + ((s0 + 1) >> 52)) >> 37;
+  s0 += over;
+  s1 += s0 >> 52;
+  *a0 = s0 & mask52;
+  *a1 = s1 & mask37;
+}
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline void AddPrime89Limbs_si512(__m512i *a0, __m512i *a1, __m512i b0,
+                                         __m512i b1) {
+  const __m512i mask52 = _mm512_set1_epi64((UINT64_C(1) << 52) - 1);
+  const __m512i mask37 = _mm512_set1_epi64((UINT64_C(1) << 37) - 1);
+  __m512i s0 = _mm512_add_epi64(*a0, b0);
+  __m512i s1 = _mm512_add_epi64(_mm512_add_epi64(*a1, b1), _mm512_srli_epi64(s0, 52));
+  s0 = _mm512_and_si512(s0, mask52);
+  const __m512i over = _mm512_srli_epi64(
+      _mm512_add_epi64(s1, _mm512_srli_epi64(
+                               _mm512_add_epi64(s0, _mm512_set1_epi64(1)), 52)),
+      37);
+  s0 = _mm512_add_epi64(s0, over);
+  s1 = _mm512_add_epi64(s1, _mm512_srli_epi64(s0, 52));
+  *a0 = _mm512_and_si512(s0, mask52);
+  *a1 = _mm512_and_si512(s1, mask37);
+}
+#endif
+
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline void AddPrime89Limbs_si256(__m256i *a0, __m256i *a1, __m256i b0,
+                                         __m256i b1) {
+  const __m256i mask52 = _mm256_set1_epi64x((UINT64_C(1) << 52) - 1);
+  const __m256i mask37 = _mm256_set1_epi64x((UINT64_C(1) << 37) - 1);
+  __m256i s0 = _mm256_add_epi64(*a0, b0);
+  __m256i s1 = _mm256_add_epi64(_mm256_add_epi64(*a1, b1), _mm256_srli_epi64(s0, 52));
+  s0 = _mm256_and_si256(s0, mask52);
+  const __m256i over = _mm256_srli_epi64(
+      _mm256_add_epi64(s1, _mm256_srli_epi64(
+                               _mm256_add_epi64(s0, _mm256_set1_epi64x(1)), 52)),
+      37);
+  s0 = _mm256_add_epi64(s0, over);
+  s1 = _mm256_add_epi64(s1, _mm256_srli_epi64(s0, 52));
+  *a0 = _mm256_and_si256(s0, mask52);
+  *a1 = _mm256_and_si256(s1, mask37);
+}
+#endif
+
+/* Turns the values v[0..degree] of a polynomial of degree at most degree at
+x, x + d, ... into its forward differences at x, modulo 2^89-1 */
+static inline void ForwardDifferencesPrime89(__uint128_t *v, int degree) {
+  const __uint128_t prime = (((__uint128_t)1) << 89) - 1;
+  for (int k = 1; k <= degree; ++k) {
+    for (int t = degree; t >= k; --t) {
+      v[t] = v[t] >= v[t - 1] ? v[t] - v[t - 1] : v[t] + prime - v[t - 1];
+    }
+  }
+}
+
+/* the forward differences of HornerPrime89 at x in steps of d, in limbs */
+static inline void DifferencesPrime89(uint64_t x, uint64_t d,
+                                      const __uint128_t *coeffs, int count,
+                                      uint64_t *v0, uint64_t *v1) {
+  __uint128_t v[4];
+  for (int t = 0; t < count; ++t) {
+    v[t] = HornerPrime89(x + t * d, coeffs, count);
+  }
+  ForwardDifferencesPrime89(v, count - 1);
+  for (int t = 0; t < count; ++t) {
+    v0[t] = (uint64_t)v[t] & ((UINT64_C(1) << 52) - 1);
+    v1[t] = (uint64_t)(v[t] >> 52);
+  }
+}
+
+/* Range version of HornerPrime89Batch, by finite differences like
+HornerPrime61Range, on the limbs of AddPrime89Limbs */
+static inline void HornerPrime89Range(uint64_t start, uint64_t stride,
+                                      size_t n, uint64_t *out,
+                                      const __uint128_t *coeffs, int count) {
+  const int degree = count - 1;
+  for (size_t i = 0; i < n;) {
+    const size_t m = range_nowrap64(start, stride, n - i);
+    size_t k = 0;
+    if (m < 256) {
+      // too short to pay for setting up the differences
+      for (; k < m; ++k) {
+        out[i + k] = start + k * stride;
+      }
+      for (k = HornerPrime89Batch(out + i, out + i, m, coeffs, count); k < m;
+           ++k) {
+        out[i + k] = (uint64_t)HornerPrime89(out[i + k], coeffs, count);
+      }
+    }
+#if defined(__AVX512F__) || defined(__AVX2__)
+#if defined(__AVX512F__)
+    const int lanes = 8;
+#else
+    const int lanes = 4;
+#endif
+    if (m >= 256) {
+      // as in HornerPrime61Range
+      uint64_t v0[4], v1[4], diff0[4][8], diff1[4][8];
+      __uint128_t first[32];
+      DifferencesPrime89(start, stride, coeffs, count, v0, v1);
+      for (int q = 0; q < lanes * count; ++q) {
+        first[q] = v0[0] + ((__uint128_t)v1[0] << 52);
+        for (int t = 0; t < degree; ++t) {
+          AddPrime89Limbs(&v0[t], &v1[t], v0[t + 1], v1[t + 1]);
+        }
+      }
+      for (int j = 0; j < lanes; ++j) {
+        __uint128_t v[4];
+        for (int t = 0; t <= degree; ++t) {
+          v[t] = first[j + lanes * t];
+        }
+        ForwardDifferencesPrime89(v, degree);
+        for (int t = 0; t <= degree; ++t) {
+          diff0[t][j] = (uint64_t)v[t] & ((UINT64_C(1) << 52) - 1);
+          diff1[t][j] = (uint64_t)(v[t] >> 52);
+        }
+      }
+#if defined(__AVX512F__)
+      __m512i h0[4], h1[4];
+      for (int t = 0; t <= degree; ++t) {
+        h0[t] = _mm512_loadu_si512(diff0[t]);
+        h1[t] = _mm512_loadu_si512(diff1[t]);
+      }
+      for (; k + 8 <= m; k += 8) {
+        _mm512_storeu_si512(out + i + k,
+                            _mm512_add_epi64(h0[0], _mm512_slli_epi64(h1[0], 52)));
+        for (int t = 0; t < degree; ++t) {
+          AddPrime89Limbs_si512(&h0[t], &h1[t], h0[t + 1], h1[t + 1]);
+        }
+      }
+#else
+      __m256i h0[4], h1[4];
+      for (int t = 0; t <= degree; ++t) {
+        h0[t] = _mm256_loadu_si256((const __m256i *)diff0[t]);
+        h1[t] = _mm256_loadu_si256((const __m256i *)diff1[t]);
+      }
+      for (; k + 4 <= m; k += 4) {
+        _mm256_storeu_si256((__m256i *)(out + i + k),
+                            _mm256_add_epi64(h0[0], _mm256_slli_epi64(h1[0], 52)));
+        for (int t = 0; t < degree; ++t) {
+          AddPrime89Limbs_si256(&h0[t], &h1[t], h0[t + 1], h1[t + 1]);
+        }
+      }
+#endif
+    }
+#endif
+    if (m - k > (size_t)count) {
+      uint64_t v0[4], v1[4];
+      DifferencesPrime89(start + k * stride, stride, coeffs, count, v0, v1);
+      for (; k < m; ++k) {
+        out[i + k] = v0[0] + (v1[0] << 52);
+        for (int t = 0; t < degree; ++t) {
+          AddPrime89Limbs(&v0[t], &v1[t], v0[t + 1], v1[t + 1]);
+        }
+      }
+    }
+    for (; k < m; ++k) {
+      out[i + k] = (uint64_t)HornerPrime89(start + k * stride, coeffs, count);
+    }
+    start += m * stride;
+    i += m;
+  }
+}
+
+void ThorupZhangCWLinear64Range(uint64_t start, uint64_t stride, size_t n,
+                                uint64_t *out, const ThorupZhangCWLinear64_t *k) {
+  const __uint128_t coeffs[2] = {INT96Value(k->A), INT96Value(k->B)};
+  HornerPrime89Range(start, stride, n, out, coeffs, 2);
+}
+
+void ThorupZhangCWQuadratic64Range(uint64_t start, uint64_t stride, size_t n,
+                                   uint64_t *out,
+                                   const ThorupZhangCWQuadratic64_t *k) {
+  const __uint128_t coeffs[3] = {INT96Value(k->A), INT96Value(k->B),
+                                 INT96Value(k->C)};
+  HornerPrime89Range(start, stride, n, out, coeffs, 3);
+}
+
+void ThorupZhangCWCubic64Range(uint64_t start, uint64_t stride, size_t n,
+                               uint64_t *out, const ThorupZhangCWCubic64_t *k) {
+  const __uint128_t coeffs[4] = {INT96Value(k->A), INT96Value(k->B),
+                                 INT96Value(k->C), INT96Value(k->D)};
+  HornerPrime89Range(start, stride, n, out, coeffs, 4);
+}
+
+void FasterCWLinear64Range(uint64_t start, uint64_t stride, size_t n,
+                           uint64_t *out, const FasterCWLinear64_t *k) {
+  const __uint128_t coeffs[2] = {k->A, k->B};
+  HornerPrime89Range(start, stride, n, out, coeffs, 2);
+}
+
+void FasterCWQuadratic64Range(uint64_t start, uint64_t stride, size_t n,
+                              uint64_t *out, const FasterCWQuadratic64_t *k) {
+  const __uint128_t coeffs[3] = {k->A, k->B, k->C};
+  HornerPrime89Range(start, stride, n, out, coeffs, 3);
+}
+
+void FasterCWCubic64Range(uint64_t start, uint64_t stride, size_t n,
+                          uint64_t *out, const FasterCWCubic64_t *k) {
+  const __uint128_t coeffs[4] = {k->A, k->B, k->C, k->D};
+  HornerPrime89Range(start, stride, n, out, coeffs, 4);
+}
+
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef FNV_H
 #define FNV_H
 
+#include "simd.h"
+
 /**
 * This is FNV-1a
 * See https://en.wikipedia.org/wiki/Fowler–Noll–Vo_hash_function
@@ -26,4 +28,38 @@ inline uint64_t fnv64(uint64_t h, const fnv64_t * key) {
   return hash;
 }
 
+// the bytes of each word, least significant first, as in fnv64 on x86
+void fnv64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                 const fnv64_t *key) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i multiplier = _mm512_set1_epi64(key->primemultiplier);
+  const __m512i bytemask = _mm512_set1_epi64(0xFF);
+  for (; i + 8 <= n; i += 8) {
+    const __m512i x = _mm512_loadu_si512(in + i);
+    __m512i hash = _mm512_set1_epi64(key->basis);
+    for (int p = 0; p < 8; p++) {
+      const __m512i c = _mm512_and_si512(_mm512_srli_epi64(x, 8 * p), bytemask);
+      hash = mullo64_si512(_mm512_xor_si512(hash, c), multiplier);
+    }
+    _mm512_storeu_si512(out + i, hash);
+  }
+#elif defined(__AVX2__)
+  const __m256i multiplier = _mm256_set1_epi64x(key->primemultiplier);
+  const __m256i bytemask = _mm256_set1_epi64x(0xFF);
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i hash = _mm256_set1_epi64x(key->basis);
+    for (int p = 0; p < 8; p++) {
+      const __m256i c = _mm256_and_si256(_mm256_srli_epi64(x, 8 * p), bytemask);
+      hash = mullo64_si256(_mm256_xor_si256(hash, c), multiplier);
+    }
+    _mm256_storeu_si256((__m256i *)(out + i), hash);
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = fnv64(in[i], key);
+  }
+}
+
 #endif
@@ -16,6 +16,7 @@
 * http://dx.doi.org/10.1145/2714064.2660195
 */
 
+#include "simd.h"
 #include "util.h"
 
 typedef struct {
@@ -47,4 +48,38 @@ inline uint64_t javasplit64(uint64_t h, const javasplit64_t * key) {
 	z = (z ^ (z >> key->shift2)) * key->multiplier3;
 	return z ^ (z >> key->shift3);
 }
+
+void javasplit64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                       const javasplit64_t *key) {
+	size_t i = 0;
+#if defined(__AVX512F__)
+	const __m512i seed = _mm512_set1_epi64(key->seed);
+	const __m512i multiplier1 = _mm512_set1_epi64(key->multiplier1);
+	const __m512i multiplier2 = _mm512_set1_epi64(key->multiplier2);
+	const __m512i multiplier3 = _mm512_set1_epi64(key->multiplier3);
+	for (; i + 8 <= n; i += 8) {
+		__m512i z = _mm512_add_epi64(_mm512_loadu_si512(in + i), seed);
+		z = mullo64_si512(z, multiplier1);
+		z = mullo64_si512(xorshift_epi64_si512(z, key->shift1), multiplier2);
+		z = mullo64_si512(xorshift_epi64_si512(z, key->shift2), multiplier3);
+		_mm512_storeu_si512(out + i, xorshift_epi64_si512(z, key->shift3));
+	}
+#elif defined(__AVX2__)
+	const __m256i seed = _mm256_set1_epi64x(key->seed);
+	const __m256i multiplier1 = _mm256_set1_epi64x(key->multiplier1);
+	const __m256i multiplier2 = _mm256_set1_epi64x(key->multiplier2);
+	const __m256i multiplier3 = _mm256_set1_epi64x(key->multiplier3);
+	for (; i + 4 <= n; i += 4) {
+		__m256i z = _mm256_add_epi64(
+			_mm256_loadu_si256((const __m256i *)(in + i)), seed);
+		z = mullo64_si256(z, multiplier1);
+		z = mullo64_si256(xorshift_epi64_si256(z, key->shift1), multiplier2);
+		z = mullo64_si256(xorshift_epi64_si256(z, key->shift2), multiplier3);
+		_mm256_storeu_si256((__m256i *)(out + i), xorshift_epi64_si256(z, key->shift3));
+	}
+#endif
+	for (; i < n; ++i) {
+		out[i] = javasplit64(in[i], key);
+	}
+}
 #endif // JAVASPLIT
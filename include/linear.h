@@ -1,26 +1,109 @@
 #ifndef SHORTHASH_LINEAR_H
 #define SHORTHASH_LINEAR_H
 
-#include <immintrin.h>
+#include "simd.h"
 
-typedef struct { uint64_t rand[64]; } Linear64Randomness;
+typedef struct {
+    uint64_t rand[64];
+    // Four Russians: table[b][v] hashes v << (8 * b)
+    uint64_t table[8][256];
+    // 8x8 blocks for gf2p8affineqb: gfni[b][k] maps input byte b to output
+    // byte k
+    uint64_t gfni[8][8];
+} Linear64Randomness;
 
-void Linear64Init(Linear64Randomness *r) {
+// The definition: one parity per row, output bit j is the parity of row 64 - j
+// (bit 0 is always zero). Linear64Init derives the faster forms from it.
+uint64_t Linear64Parity(uint64_t val, const Linear64Randomness *r) {
+    uint64_t result = 0;
     for (int i = 0; i < 64; ++i) {
-        r->rand[i] = get64rand();
+        const uint64_t p = __builtin_parityll(val & r->rand[i]);
+        result |= p;
+        result <<= 1;
+    }
+    return result;
+}
+
+void Linear64Init(Linear64Randomness *r) {
+    fill64rand(r->rand, 64);
+    for (int b = 0; b < 8; ++b) {
+        for (int v = 0; v < 256; ++v) {
+            r->table[b][v] = Linear64Parity((uint64_t)v << (8 * b), r);
+        }
+    }
+    // gf2p8affineqb computes bit t of a byte as the parity of matrix byte 7 - t
+    // and the input byte
+    for (int b = 0; b < 8; ++b) {
+        for (int k = 0; k < 8; ++k) {
+            uint64_t block = 0;
+            for (int t = 0; t < 8; ++t) {
+                const int j = 8 * k + t;
+                const uint64_t row = (j == 0) ? 0 : r->rand[64 - j];
+                block |= ((row >> (8 * b)) & 0xFF) << (8 * (7 - t));
+            }
+            r->gfni[b][k] = block;
+        }
     }
 }
 
 uint64_t Linear64(uint64_t val, const Linear64Randomness *r) {
     uint64_t result = 0;
-    for (int i = 0; i < 64; ++i) {
-        const uint64_t p = __builtin_parityll(val & r->rand[i]);
-        result |= p;
-        result <<= 1;
+    for (int b = 0; b < 8; ++b) {
+        result ^= r->table[b][(val >> (8 * b)) & 0xFF];
     }
     return result;
 }
 
+// With GFNI, 8 keys at a time: for each input byte b, vpermb spreads byte b of
+// every key across the 8 output bytes, gf2p8affineqb applies the blocks
+// gfni[b][k], and a last vpermb moves the output bytes back to their keys.
+void Linear64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                   const Linear64Randomness *r) {
+    size_t i = 0;
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    uint8_t spread[8][64], gather[64];
+    for (int k = 0; k < 8; ++k) {
+        for (int key = 0; key < 8; ++key) {
+            for (int b = 0; b < 8; ++b) {
+                spread[b][8 * k + key] = 8 * key + b;
+            }
+            gather[8 * key + k] = 8 * k + key;
+        }
+    }
+    __m512i spreadidx[8], blocks[8];
+    for (int b = 0; b < 8; ++b) {
+        spreadidx[b] = _mm512_loadu_si512(spread[b]);
+        blocks[b] = _mm512_loadu_si512(r->gfni[b]);
+    }
+    const __m512i gatheridx = _mm512_loadu_si512(gather);
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        __m512i y = _mm512_setzero_si512();
+        for (int b = 0; b < 8; ++b) {
+            const __m512i xb = _mm512_permutexvar_epi8(spreadidx[b], x);
+            y = _mm512_xor_si512(y, _mm512_gf2p8affine_epi64_epi8(xb, blocks[b], 0));
+        }
+        _mm512_storeu_si512(out + i, _mm512_permutexvar_epi8(gatheridx, y));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = Linear64(in[i], r);
+    }
+}
+
+// Linear64(newval, r) given h = Linear64(oldval, r): one table row per byte
+// of oldval ^ newval that is not zero.
+inline uint64_t Linear64Update(uint64_t h, uint64_t oldval, uint64_t newval,
+                               const Linear64Randomness *r) {
+    uint64_t diff = oldval ^ newval;
+    while (diff != 0) {
+        const int b = __builtin_ctzll(diff) / 8;
+        h ^= r->table[b][(diff >> (8 * b)) & 0xFF];
+        diff &= ~(UINT64_C(0xFF) << (8 * b));
+    }
+    return h;
+}
+
 typedef struct { __m128i rand; } Toeplitz64Randomness;
 
 void Toeplitz64Init(Toeplitz64Randomness *r) {
@@ -33,8 +116,61 @@ uint64_t Toeplitz64(uint64_t val, const Toeplitz64Randomness *r) {
     const __m128i hi = _mm_clmulepi64_si128(in, r->rand, 0x10);
     const uint64_t x = _mm_extract_epi64(lo, 0);
     const uint64_t y = _mm_extract_epi64(hi, 1) << 1;
-    const uint64_t z = _mm_extract_epi64(hi, 0) >> 63;
+    const uint64_t z = (uint64_t)_mm_extract_epi64(hi, 0) >> 63;
     return x ^ (y | z);
 }
 
+// Toeplitz64 on each 128-bit lane, see load_split_epi64_si512
+#ifdef SHORTHASH_VPCLMUL512
+__attribute__((always_inline))
+static inline __m512i Toeplitz64_si512(__m512i in, __m512i rand) {
+    const __m512i lo = _mm512_clmulepi64_epi128(in, rand, 0x00);
+    const __m512i hi = _mm512_clmulepi64_epi128(in, rand, 0x10);
+    const __m512i y = _mm512_slli_epi64(_mm512_bsrli_epi128(hi, 8), 1);
+    const __m512i z = _mm512_srli_epi64(hi, 63);
+    return _mm512_xor_si512(lo, _mm512_or_si512(y, z));
+}
+#endif
+
+#ifdef SHORTHASH_VPCLMUL256
+__attribute__((always_inline))
+static inline __m256i Toeplitz64_si256(__m256i in, __m256i rand) {
+    const __m256i lo = _mm256_clmulepi64_epi128(in, rand, 0x00);
+    const __m256i hi = _mm256_clmulepi64_epi128(in, rand, 0x10);
+    const __m256i y = _mm256_slli_epi64(_mm256_bsrli_epi128(hi, 8), 1);
+    const __m256i z = _mm256_srli_epi64(hi, 63);
+    return _mm256_xor_si256(lo, _mm256_or_si256(y, z));
+}
+#endif
+
+void Toeplitz64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                     const Toeplitz64Randomness *r) {
+    size_t i = 0;
+#if defined(SHORTHASH_VPCLMUL512)
+    const __m512i rand = _mm512_broadcast_i32x4(r->rand);
+    for (; i + 8 <= n; i += 8) {
+        __m512i even, odd;
+        load_split_epi64_si512(in + i, &even, &odd);
+        store_merge_epi64_si512(out + i, Toeplitz64_si512(even, rand),
+                                Toeplitz64_si512(odd, rand));
+    }
+#elif defined(SHORTHASH_VPCLMUL256)
+    const __m256i rand = _mm256_broadcastsi128_si256(r->rand);
+    for (; i + 4 <= n; i += 4) {
+        __m256i even, odd;
+        load_split_epi64_si256(in + i, &even, &odd);
+        store_merge_epi64_si256(out + i, Toeplitz64_si256(even, rand),
+                                Toeplitz64_si256(odd, rand));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = Toeplitz64(in[i], r);
+    }
+}
+
+inline uint64_t Toeplitz64Update(uint64_t h, uint64_t oldval, uint64_t newval,
+                                 const Toeplitz64Randomness *r) {
+    return h ^ Toeplitz64(oldval ^ newval, r);
+}
+
 #endif
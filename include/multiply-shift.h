@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include "simd.h"
 #include "util.h"
 
 
@@ -21,6 +22,29 @@ inline uint64_t bitmixing(uint64_t x, const bitmixing_t *t) {
   return (t->multiplier * x ) >> 32;
 }
 
+void bitmixing_batch(const uint64_t *in, uint64_t *out, size_t n,
+                     const bitmixing_t *t) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i multiplier = _mm512_set1_epi64(t->multiplier);
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i,
+                            _mm512_srli_epi64(mullo64_si512(x, multiplier), 32));
+    }
+#elif defined(__AVX2__)
+    const __m256i multiplier = _mm256_set1_epi64x(t->multiplier);
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_srli_epi64(mullo64_si256(x, multiplier), 32));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = bitmixing(in[i], t);
+    }
+}
+
 
 /**
 * The compiler is probably smart enough to do it right, but if not:
@@ -53,6 +77,130 @@ inline uint64_t MultiplyShift64(uint64_t in, const MultiplyShift64Randomness * r
   return ((((uint128_t)in) * rand->mult) + rand->add) >> 64;
 }
 
+// (x * m) mod 2^128 >> 64 on each lane, for m = mhi 2^64 + mlo
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i mulshift128_si512(__m512i x, __m512i mlo, __m512i mhi) {
+  return _mm512_add_epi64(mulhi64_si512(x, mlo), mullo64_si512(x, mhi));
+}
+#endif
+
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline __m256i mulshift128_si256(__m256i x, __m256i mlo, __m256i mhi) {
+  return _mm256_add_epi64(mulhi64_si256(x, mlo), mullo64_si256(x, mhi));
+}
+#endif
+
+void MultiplyShift64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                          const MultiplyShift64Randomness *rand) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i mlo = _mm512_set1_epi64((uint64_t)rand->mult);
+  const __m512i mhi = _mm512_set1_epi64((uint64_t)(rand->mult >> 64));
+  const __m512i alo = _mm512_set1_epi64((uint64_t)rand->add);
+  const __m512i ahi = _mm512_set1_epi64((uint64_t)(rand->add >> 64));
+  for (; i + 8 <= n; i += 8) {
+    const __m512i x = _mm512_loadu_si512(in + i);
+    __m512i product;
+    const __m512i high = mul64_si512(x, mlo, &product);
+    const __m512i lo = _mm512_add_epi64(product, alo);
+    // carry out of the low 64 bits of x * mult + add
+    const __mmask8 carry = _mm512_cmplt_epu64_mask(lo, alo);
+    const __m512i hi = _mm512_add_epi64(
+        _mm512_add_epi64(high, mullo64_si512(x, mhi)), ahi);
+    _mm512_storeu_si512(out + i,
+                        _mm512_mask_add_epi64(hi, carry, hi, _mm512_set1_epi64(1)));
+  }
+#elif defined(__AVX2__)
+  const __m256i mlo = _mm256_set1_epi64x((uint64_t)rand->mult);
+  const __m256i mhi = _mm256_set1_epi64x((uint64_t)(rand->mult >> 64));
+  const __m256i alo = _mm256_set1_epi64x((uint64_t)rand->add);
+  const __m256i ahi = _mm256_set1_epi64x((uint64_t)(rand->add >> 64));
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i product;
+    const __m256i high = mul64_si256(x, mlo, &product);
+    const __m256i lo = _mm256_add_epi64(product, alo);
+    // carry out of product + alo, from the top bits of the operands and sum
+    const __m256i carry = _mm256_srli_epi64(
+        _mm256_or_si256(_mm256_and_si256(product, alo),
+                        _mm256_andnot_si256(lo, _mm256_or_si256(product, alo))),
+        63);
+    const __m256i hi = _mm256_add_epi64(
+        _mm256_add_epi64(high, mullo64_si256(x, mhi)), ahi);
+    _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi64(hi, carry));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = MultiplyShift64(in[i], rand);
+  }
+}
+
+// h(x + d) = h(x) + d mult before the shift, so the range kernels keep
+// x mult + add for one key per lane and step the lanes by (lanes) stride mult:
+// additions only, once the lanes are set up for a run of keys. The scalar
+// code steps one key at a time.
+void MultiplyShift64Range(uint64_t start, uint64_t stride, size_t n,
+                          uint64_t *out, const MultiplyShift64Randomness *rand) {
+  for (size_t i = 0; i < n;) {
+    const size_t m = range_nowrap64(start, stride, n - i);
+    size_t k = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+#if defined(__AVX512F__)
+    const int lanes = 8;
+#else
+    const int lanes = 4;
+#endif
+    if (m >= (size_t)lanes) {
+      uint64_t lo[8], hi[8];
+      for (int j = 0; j < lanes; ++j) {
+        const uint128_t v = ((uint128_t)(start + j * stride)) * rand->mult + rand->add;
+        lo[j] = (uint64_t)v;
+        hi[j] = (uint64_t)(v >> 64);
+      }
+      const uint128_t step = ((uint128_t)stride) * lanes * rand->mult;
+#if defined(__AVX512F__)
+      const __m512i slo = _mm512_set1_epi64((uint64_t)step);
+      const __m512i shi = _mm512_set1_epi64((uint64_t)(step >> 64));
+      __m512i vlo = _mm512_loadu_si512(lo), vhi = _mm512_loadu_si512(hi);
+      for (; k + 8 <= m; k += 8) {
+        _mm512_storeu_si512(out + i + k, vhi);
+        vlo = _mm512_add_epi64(vlo, slo);
+        const __mmask8 carry = _mm512_cmplt_epu64_mask(vlo, slo);
+        vhi = _mm512_add_epi64(vhi, shi);
+        vhi = _mm512_mask_add_epi64(vhi, carry, vhi, _mm512_set1_epi64(1));
+      }
+#else
+      const __m256i slo = _mm256_set1_epi64x((uint64_t)step);
+      const __m256i shi = _mm256_set1_epi64x((uint64_t)(step >> 64));
+      __m256i vlo = _mm256_loadu_si256((const __m256i *)lo);
+      __m256i vhi = _mm256_loadu_si256((const __m256i *)hi);
+      for (; k + 4 <= m; k += 4) {
+        _mm256_storeu_si256((__m256i *)(out + i + k), vhi);
+        const __m256i sum = _mm256_add_epi64(vlo, slo);
+        // carry out of vlo + slo, as in MultiplyShift64Batch
+        const __m256i carry = _mm256_srli_epi64(
+            _mm256_or_si256(_mm256_and_si256(vlo, slo),
+                            _mm256_andnot_si256(sum, _mm256_or_si256(vlo, slo))),
+            63);
+        vlo = sum;
+        vhi = _mm256_add_epi64(_mm256_add_epi64(vhi, shi), carry);
+      }
+#endif
+    }
+#endif
+    uint128_t v = ((uint128_t)(start + k * stride)) * rand->mult + rand->add;
+    const uint128_t step = ((uint128_t)stride) * rand->mult;
+    for (; k < m; ++k) {
+      out[i + k] = v >> 64;
+      v += step;
+    }
+    start += m * stride;
+    i += m;
+  }
+}
+
 typedef struct {
   uint64_t mult;
 } UnivMultiplyShift64Randomness;
@@ -66,6 +214,62 @@ inline uint64_t UnivMultiplyShift64(uint64_t in, const UnivMultiplyShift64Random
   return in * rand->mult;
 }
 
+void UnivMultiplyShift64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                              const UnivMultiplyShift64Randomness *rand) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i mult = _mm512_set1_epi64(rand->mult);
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_si512(out + i, mullo64_si512(_mm512_loadu_si512(in + i), mult));
+  }
+#elif defined(__AVX2__)
+  const __m256i mult = _mm256_set1_epi64x(rand->mult);
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_si256((__m256i *)(out + i),
+                        mullo64_si256(_mm256_loadu_si256((const __m256i *)(in + i)), mult));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = UnivMultiplyShift64(in[i], rand);
+  }
+}
+
+// no runs here: wrapping around 2^64 does not change x mult mod 2^64
+void UnivMultiplyShift64Range(uint64_t start, uint64_t stride, size_t n,
+                              uint64_t *out,
+                              const UnivMultiplyShift64Randomness *rand) {
+  size_t k = 0;
+#if defined(__AVX512F__)
+  const __m512i step = _mm512_set1_epi64(8 * stride * rand->mult);
+  __m512i h = mullo64_si512(
+      _mm512_add_epi64(_mm512_set1_epi64(start),
+                       mullo64_si512(_mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0),
+                                     _mm512_set1_epi64(stride))),
+      _mm512_set1_epi64(rand->mult));
+  for (; k + 8 <= n; k += 8) {
+    _mm512_storeu_si512(out + k, h);
+    h = _mm512_add_epi64(h, step);
+  }
+#elif defined(__AVX2__)
+  const __m256i step = _mm256_set1_epi64x(4 * stride * rand->mult);
+  __m256i h = mullo64_si256(
+      _mm256_add_epi64(_mm256_set1_epi64x(start),
+                       mullo64_si256(_mm256_set_epi64x(3, 2, 1, 0),
+                                     _mm256_set1_epi64x(stride))),
+      _mm256_set1_epi64x(rand->mult));
+  for (; k + 4 <= n; k += 4) {
+    _mm256_storeu_si256((__m256i *)(out + k), h);
+    h = _mm256_add_epi64(h, step);
+  }
+#endif
+  uint64_t h1 = (start + k * stride) * rand->mult;
+  const uint64_t step1 = stride * rand->mult;
+  for (; k < n; ++k) {
+    out[k] = h1;
+    h1 += step1;
+  }
+}
+
 typedef struct {
   uint128_t mult1, mult2;
 } MultiplyTwice64Randomness;
@@ -81,6 +285,37 @@ __attribute__((always_inline)) inline uint64_t
            ((((uint128_t)in) * rand->mult2) >> 64);
 }
 
+void MultiplyTwice64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                          const MultiplyTwice64Randomness *rand) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i m1lo = _mm512_set1_epi64((uint64_t)rand->mult1);
+    const __m512i m1hi = _mm512_set1_epi64((uint64_t)(rand->mult1 >> 64));
+    const __m512i m2lo = _mm512_set1_epi64((uint64_t)rand->mult2);
+    const __m512i m2hi = _mm512_set1_epi64((uint64_t)(rand->mult2 >> 64));
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i,
+                            _mm512_xor_si512(mulshift128_si512(x, m1lo, m1hi),
+                                             mulshift128_si512(x, m2lo, m2hi)));
+    }
+#elif defined(__AVX2__)
+    const __m256i m1lo = _mm256_set1_epi64x((uint64_t)rand->mult1);
+    const __m256i m1hi = _mm256_set1_epi64x((uint64_t)(rand->mult1 >> 64));
+    const __m256i m2lo = _mm256_set1_epi64x((uint64_t)rand->mult2);
+    const __m256i m2hi = _mm256_set1_epi64x((uint64_t)(rand->mult2 >> 64));
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_xor_si256(mulshift128_si256(x, m1lo, m1hi),
+                                             mulshift128_si256(x, m2lo, m2hi)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = MultiplyTwice64(in[i], rand);
+    }
+}
+
 typedef struct {
   uint128_t mults[3];
 } MultiplyThrice64Randomness;
@@ -100,6 +335,68 @@ __attribute__((always_inline)) inline uint64_t
     return ans;
 }
 
+void MultiplyThrice64Batch(const uint64_t *in, uint64_t *out, size_t n,
+                           const MultiplyThrice64Randomness *rand) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    __m512i mlo[3], mhi[3];
+    for (int j = 0; j < 3; ++j) {
+        mlo[j] = _mm512_set1_epi64((uint64_t)rand->mults[j]);
+        mhi[j] = _mm512_set1_epi64((uint64_t)(rand->mults[j] >> 64));
+    }
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        __m512i ans = mulshift128_si512(x, mlo[0], mhi[0]);
+        for (int j = 1; j < 3; ++j) {
+            ans = _mm512_xor_si512(ans, mulshift128_si512(x, mlo[j], mhi[j]));
+        }
+        _mm512_storeu_si512(out + i, ans);
+    }
+#elif defined(__AVX2__)
+    __m256i mlo[3], mhi[3];
+    for (int j = 0; j < 3; ++j) {
+        mlo[j] = _mm256_set1_epi64x((uint64_t)rand->mults[j]);
+        mhi[j] = _mm256_set1_epi64x((uint64_t)(rand->mults[j] >> 64));
+    }
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i ans = mulshift128_si256(x, mlo[0], mhi[0]);
+        for (int j = 1; j < 3; ++j) {
+            ans = _mm256_xor_si256(ans, mulshift128_si256(x, mlo[j], mhi[j]));
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), ans);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = MultiplyThrice64(in[i], rand);
+    }
+}
+
+// Pair-multiply-shift for 128-bit keys, from M. Thorup. "High speed hashing
+// for integers and strings." arXiv:1504.06804, 2015: the limbs x0 (low) and
+// x1 (high) of the key are multiplied with each other,
+//   ((mult[0] + x1) (mult[1] + x0) + add) mod 2^128,
+// and the top 64 bits are strongly universal, like those of MultiplyShift64.
+// One product of two 128-bit numbers (three 64-bit multiplications) per key.
+typedef struct {
+  uint128_t mult[2], add;
+} PairMultiplyShift128Randomness;
+
+void PairMultiplyShift128Init(PairMultiplyShift128Randomness *x) {
+  x->mult[0] = get128rand();
+  x->mult[1] = get128rand();
+  x->add = get128rand();
+}
+
+// the hash is in the low 64 bits, for HashBits::HIGH hash tables
+__attribute__((always_inline))
+inline uint128_t PairMultiplyShift128(uint128_t in,
+                                      const PairMultiplyShift128Randomness *rand) {
+  return ((rand->mult[0] + (uint64_t)(in >> 64)) *
+              (rand->mult[1] + (uint64_t)in) +
+          rand->add) >> 64;
+}
+
 typedef struct {
   uint64_t mult, add;
 } MultiplyShift32Randomness;
@@ -114,6 +411,96 @@ inline uint32_t MultiplyShift32(uint32_t in, const MultiplyShift32Randomness * r
   return ((((uint64_t)in) * rand->mult) + rand->add) >> 32;
 }
 
+// in * mult + add is in * mlo + add plus (in * mhi mod 2^32) 2^32, so the top
+// half comes from one vpmuludq per key and one vpmulld per 32-bit lane
+void MultiplyShift32Batch(const uint32_t *in, uint32_t *out, size_t n,
+                          const MultiplyShift32Randomness *rand) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i mlo = _mm512_set1_epi64(rand->mult);
+  const __m512i mhi = _mm512_set1_epi32((uint32_t)(rand->mult >> 32));
+  const __m512i add = _mm512_set1_epi64(rand->add);
+  for (; i + 16 <= n; i += 16) {
+    __m512i even, odd;
+    load_even_odd_epu32_si512(in + i, &even, &odd);
+    const __m512i he = _mm512_add_epi64(_mm512_mul_epu32(even, mlo), add);
+    const __m512i ho = _mm512_add_epi64(_mm512_mul_epu32(odd, mlo), add);
+    // the high halves, back in key order
+    const __m512i h = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(he, 32), ho);
+    _mm512_storeu_si512(out + i, _mm512_add_epi32(h, _mm512_mullo_epi32(even, mhi)));
+  }
+#elif defined(__AVX2__)
+  const __m256i mlo = _mm256_set1_epi64x(rand->mult);
+  const __m256i mhi = _mm256_set1_epi32((uint32_t)(rand->mult >> 32));
+  const __m256i add = _mm256_set1_epi64x(rand->add);
+  for (; i + 8 <= n; i += 8) {
+    __m256i even, odd;
+    load_even_odd_epu32_si256(in + i, &even, &odd);
+    const __m256i he = _mm256_add_epi64(_mm256_mul_epu32(even, mlo), add);
+    const __m256i ho = _mm256_add_epi64(_mm256_mul_epu32(odd, mlo), add);
+    const __m256i h = _mm256_blend_epi32(_mm256_srli_epi64(he, 32), ho, 0xAA);
+    _mm256_storeu_si256((__m256i *)(out + i),
+                        _mm256_add_epi32(h, _mm256_mullo_epi32(even, mhi)));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = MultiplyShift32(in[i], rand);
+  }
+}
+
+// the lanes hold the even and the odd keys, as in MultiplyShift32Batch
+void MultiplyShift32Range(uint32_t start, uint32_t stride, size_t n,
+                          uint32_t *out, const MultiplyShift32Randomness *rand) {
+  for (size_t i = 0; i < n;) {
+    const size_t m = range_nowrap32(start, stride, n - i);
+    size_t k = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+#if defined(__AVX512F__)
+    const int lanes = 16;
+#else
+    const int lanes = 8;
+#endif
+    if (m >= (size_t)lanes) {
+      uint64_t h[16];
+      for (int j = 0; j < lanes; ++j) {
+        // key j goes to lane j / 2 of the even or the odd vector
+        h[(j & 1) * lanes / 2 + j / 2] =
+            ((uint64_t)start + (uint64_t)j * stride) * rand->mult + rand->add;
+      }
+      const uint64_t step = (uint64_t)stride * lanes * rand->mult;
+#if defined(__AVX512F__)
+      const __m512i vstep = _mm512_set1_epi64(step);
+      __m512i even = _mm512_loadu_si512(h), odd = _mm512_loadu_si512(h + 8);
+      for (; k + 16 <= m; k += 16) {
+        store_even_odd_epu32_si512(out + i + k, _mm512_srli_epi64(even, 32),
+                                   _mm512_srli_epi64(odd, 32));
+        even = _mm512_add_epi64(even, vstep);
+        odd = _mm512_add_epi64(odd, vstep);
+      }
+#else
+      const __m256i vstep = _mm256_set1_epi64x(step);
+      __m256i even = _mm256_loadu_si256((const __m256i *)h);
+      __m256i odd = _mm256_loadu_si256((const __m256i *)(h + 4));
+      for (; k + 8 <= m; k += 8) {
+        store_even_odd_epu32_si256(out + i + k, _mm256_srli_epi64(even, 32),
+                                   _mm256_srli_epi64(odd, 32));
+        even = _mm256_add_epi64(even, vstep);
+        odd = _mm256_add_epi64(odd, vstep);
+      }
+#endif
+    }
+#endif
+    uint64_t h1 = ((uint64_t)start + (uint64_t)k * stride) * rand->mult + rand->add;
+    const uint64_t step1 = (uint64_t)stride * rand->mult;
+    for (; k < m; ++k) {
+      out[i + k] = h1 >> 32;
+      h1 += step1;
+    }
+    start += (uint32_t)m * stride;
+    i += m;
+  }
+}
+
 typedef struct {
   uint16_t mult;
 } MultiplyOnly8Randomness;
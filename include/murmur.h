@@ -1,6 +1,8 @@
 #ifndef MURMUR_H
 #define MURMUR_H
 
+#include "simd.h"
+
 /**
 * See https://github.com/aappleby/smhasher/wiki/MurmurHash3
 */
@@ -30,6 +32,33 @@ inline uint32_t murmur32(uint32_t h, const murmur32_t * key) {
   return h;
 }
 
+void murmur32_batch(const uint32_t *in, uint32_t *out, size_t n,
+                    const murmur32_t *key) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i multiplier1 = _mm512_set1_epi32(key->multiplier1);
+  const __m512i multiplier2 = _mm512_set1_epi32(key->multiplier2);
+  for (; i + 16 <= n; i += 16) {
+    __m512i h = _mm512_loadu_si512(in + i);
+    h = _mm512_mullo_epi32(xorshift_epi32_si512(h, key->shift1), multiplier1);
+    h = _mm512_mullo_epi32(xorshift_epi32_si512(h, key->shift2), multiplier2);
+    _mm512_storeu_si512(out + i, xorshift_epi32_si512(h, key->shift3));
+  }
+#elif defined(__AVX2__)
+  const __m256i multiplier1 = _mm256_set1_epi32(key->multiplier1);
+  const __m256i multiplier2 = _mm256_set1_epi32(key->multiplier2);
+  for (; i + 8 <= n; i += 8) {
+    __m256i h = _mm256_loadu_si256((const __m256i *)(in + i));
+    h = _mm256_mullo_epi32(xorshift_epi32_si256(h, key->shift1), multiplier1);
+    h = _mm256_mullo_epi32(xorshift_epi32_si256(h, key->shift2), multiplier2);
+    _mm256_storeu_si256((__m256i *)(out + i), xorshift_epi32_si256(h, key->shift3));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = murmur32(in[i], key);
+  }
+}
+
 
 typedef struct {
   int shift1;
@@ -57,6 +86,34 @@ inline uint64_t murmur64(uint64_t h, const murmur64_t * key) {
   return h;
 }
 
+// one kernel for every murmur64_t family (murmur64, stafford, xxHash)
+void murmur64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                    const murmur64_t *key) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i multiplier1 = _mm512_set1_epi64(key->multiplier1);
+  const __m512i multiplier2 = _mm512_set1_epi64(key->multiplier2);
+  for (; i + 8 <= n; i += 8) {
+    __m512i h = _mm512_loadu_si512(in + i);
+    h = mullo64_si512(xorshift_epi64_si512(h, key->shift1), multiplier1);
+    h = mullo64_si512(xorshift_epi64_si512(h, key->shift2), multiplier2);
+    _mm512_storeu_si512(out + i, xorshift_epi64_si512(h, key->shift3));
+  }
+#elif defined(__AVX2__)
+  const __m256i multiplier1 = _mm256_set1_epi64x(key->multiplier1);
+  const __m256i multiplier2 = _mm256_set1_epi64x(key->multiplier2);
+  for (; i + 4 <= n; i += 4) {
+    __m256i h = _mm256_loadu_si256((const __m256i *)(in + i));
+    h = mullo64_si256(xorshift_epi64_si256(h, key->shift1), multiplier1);
+    h = mullo64_si256(xorshift_epi64_si256(h, key->shift2), multiplier2);
+    _mm256_storeu_si256((__m256i *)(out + i), xorshift_epi64_si256(h, key->shift3));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = murmur64(in[i], key);
+  }
+}
+
 //http://zimbry.blogspot.ca/2011/09/better-bit-mixing-improving-on.html
 void staffordmix01_init(murmur64_t *key) {
   key->shift1 = 31;
@@ -105,6 +162,30 @@ inline uint64_t koloboke64(uint64_t h, const koloboke_t * key) {
   return h;
 }
 
+void koloboke64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                      const koloboke_t *key) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  const __m512i multiplier = _mm512_set1_epi64(key->multiplier);
+  for (; i + 8 <= n; i += 8) {
+    __m512i h = mullo64_si512(_mm512_loadu_si512(in + i), multiplier);
+    h = xorshift_epi64_si512(h, key->shift1);
+    _mm512_storeu_si512(out + i, xorshift_epi64_si512(h, key->shift2));
+  }
+#elif defined(__AVX2__)
+  const __m256i multiplier = _mm256_set1_epi64x(key->multiplier);
+  for (; i + 4 <= n; i += 4) {
+    __m256i h = mullo64_si256(_mm256_loadu_si256((const __m256i *)(in + i)),
+                              multiplier);
+    h = xorshift_epi64_si256(h, key->shift1);
+    _mm256_storeu_si256((__m256i *)(out + i), xorshift_epi64_si256(h, key->shift2));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = koloboke64(in[i], key);
+  }
+}
+
 typedef struct {
     // Random multiplier
     uint64_t multiplier;
@@ -121,6 +202,31 @@ __attribute__((always_inline)) inline uint64_t
     return h;
 }
 
+void random_koloboke64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                             const random_koloboke_t *key) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i multiplier = _mm512_set1_epi64(key->multiplier);
+    for (; i + 8 <= n; i += 8) {
+        __m512i h = mullo64_si512(_mm512_loadu_si512(in + i), multiplier);
+        h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 32));
+        _mm512_storeu_si512(out + i, _mm512_xor_si512(h, _mm512_srli_epi64(h, 16)));
+    }
+#elif defined(__AVX2__)
+    const __m256i multiplier = _mm256_set1_epi64x(key->multiplier);
+    for (; i + 4 <= n; i += 4) {
+        __m256i h = mullo64_si256(_mm256_loadu_si256((const __m256i *)(in + i)),
+                                  multiplier);
+        h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 32));
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_xor_si256(h, _mm256_srli_epi64(h, 16)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = random_koloboke64(in[i], key);
+    }
+}
+
 typedef struct {
     // Random multiplier, only one shift
     uint64_t multiplier;
@@ -136,4 +242,27 @@ __attribute__((always_inline)) inline uint64_t
     return h;
 }
 
+void random_weak_koloboke64_batch(const uint64_t *in, uint64_t *out, size_t n,
+                                  const random_weak_koloboke_t *key) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i multiplier = _mm512_set1_epi64(key->multiplier);
+    for (; i + 8 <= n; i += 8) {
+        const __m512i h = mullo64_si512(_mm512_loadu_si512(in + i), multiplier);
+        _mm512_storeu_si512(out + i, _mm512_xor_si512(h, _mm512_srli_epi64(h, 32)));
+    }
+#elif defined(__AVX2__)
+    const __m256i multiplier = _mm256_set1_epi64x(key->multiplier);
+    for (; i + 4 <= n; i += 4) {
+        const __m256i h = mullo64_si256(
+            _mm256_loadu_si256((const __m256i *)(in + i)), multiplier);
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_xor_si256(h, _mm256_srli_epi64(h, 32)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = random_weak_koloboke64(in[i], key);
+    }
+}
+
 #endif
@@ -0,0 +1,348 @@
+#ifndef SHORTHASH_ROLLING_H
+#define SHORTHASH_ROLLING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include "simd.h"
+#include "util.h"
+
+/**
+Rolling (recursive) n-gram hashing, as analyzed in
+"Recursive n-gram hashing is pairwise independent, at best":
+the hash of every window of n bytes of a buffer, in O(1) per byte.
+
+With a random table T over bytes, the window s_0 ... s_{n-1} hashes to
+- CYCLIC (buzhash): the xor of T[s_j] rotated right by j. With n = 8 this is
+  cyclic() on the 8 bytes read as a little-endian word, with the same table.
+- GENERAL: the sum of x^(n-1-j) T[s_j] in GF(2)[x] modulo the irreducible
+  x^64 + x^4 + x^3 + x + 1 (the clhash polynomial). Unlike CYCLIC, it does
+  not degrade when n is a multiple of 64.
+
+Sliding by one byte multiplies by x (CYCLIC: rotates left by one), removes
+the outgoing byte with one row of outtab and adds the incoming byte with one
+row of intab.
+*/
+
+typedef struct rolling_s {
+    uint64_t intab[1 << CHAR_BIT];  // row of a byte entering the window
+    uint64_t outtab[1 << CHAR_BIT]; // row of the same byte leaving it
+    uint64_t hashtab[1 << CHAR_BIT];
+    // inbytes[b][c] is byte b of intab[c] (outbytes: of outtab[c]), for the
+    // vpermi2b lookups of rolling_hash_lanes; entries 128 and up are stored
+    // xored with the entry 128 below
+    uint8_t inbytes[8][1 << CHAR_BIT];
+    uint8_t outbytes[8][1 << CHAR_BIT];
+    size_t n;                       // window length in bytes
+    int general;
+} rolling_t;
+
+static inline uint64_t rolling_rotl(uint64_t x, int r) {
+    r &= 63;
+    return r == 0 ? x : (x << r) | (x >> (64 - r));
+}
+
+// x * h in GF(2)[x] / (x^64 + x^4 + x^3 + x + 1)
+__attribute__((always_inline))
+static inline uint64_t rolling_mulx(uint64_t h) {
+    return (h << 1) ^ ((0 - (h >> 63)) & UINT64_C(0x1B));
+}
+
+static void rolling_init_tables(rolling_t *k) {
+    for (int c = 0; c < (1 << CHAR_BIT); ++c) {
+        if (k->general) {
+            uint64_t t = k->hashtab[c];
+            k->intab[c] = t;
+            for (size_t j = 0; j < k->n; ++j) {
+                t = rolling_mulx(t);
+            }
+            k->outtab[c] = t;
+        } else {
+            k->intab[c] = rolling_rotl(k->hashtab[c], -(int)((k->n - 1) & 63));
+            k->outtab[c] = rolling_rotl(k->hashtab[c], 1);
+        }
+    }
+    for (int b = 0; b < 8; ++b) {
+        for (int c = 0; c < (1 << CHAR_BIT); ++c) {
+            uint64_t in = k->intab[c], out = k->outtab[c];
+            if (c >= 128) {
+                in ^= k->intab[c - 128];
+                out ^= k->outtab[c - 128];
+            }
+            k->inbytes[b][c] = (uint8_t)(in >> (8 * b));
+            k->outbytes[b][c] = (uint8_t)(out >> (8 * b));
+        }
+    }
+}
+
+// windows of n >= 1 bytes
+void rolling_cyclic_init(rolling_t *k, size_t n) {
+    fill64rand(k->hashtab, 1 << CHAR_BIT);
+    k->n = n;
+    k->general = 0;
+    rolling_init_tables(k);
+}
+
+void rolling_general_init(rolling_t *k, size_t n) {
+    fill64rand(k->hashtab, 1 << CHAR_BIT);
+    k->n = n;
+    k->general = 1;
+    rolling_init_tables(k);
+}
+
+__attribute__((always_inline))
+static inline uint64_t rolling_step(uint64_t h, const int general) {
+    return general ? rolling_mulx(h) : rolling_rotl(h, 1);
+}
+
+// the hash of the window s[0 .. n - 1], from scratch
+__attribute__((always_inline))
+static inline uint64_t rolling_window_impl(const unsigned char *s,
+                                           const rolling_t *k,
+                                           const int general) {
+    uint64_t h = 0;
+    for (size_t j = 0; j < k->n; ++j) {
+        h = rolling_step(h, general) ^ k->intab[s[j]];
+    }
+    return h;
+}
+
+uint64_t rolling_window(const unsigned char *s, const rolling_t *k) {
+    return k->general ? rolling_window_impl(s, k, 1)
+                      : rolling_window_impl(s, k, 0);
+}
+
+// out[w] for from <= w < to, given h, the hash of window from - 1
+__attribute__((always_inline))
+static inline void rolling_roll(const unsigned char *s, size_t from,
+                                size_t to, uint64_t h, uint64_t *out,
+                                const rolling_t *k, const int general) {
+    const unsigned char *in = s + k->n - 1;
+    for (size_t w = from; w < to; ++w) {
+        h = rolling_step(h, general) ^ (k->outtab[s[w - 1]] ^ k->intab[in[w]]);
+        out[w] = h;
+    }
+}
+
+// Rolling is a chain of dependent steps, one per byte. rolling_hash cuts the
+// windows into 4 runs and rolls them side by side, so that the steps of
+// different runs overlap; each run starts with a hash from scratch.
+//
+// The runs are kept in scalar registers on purpose: the vector lanes of
+// rolling_hash_lanes spend more on transposes than they save on steps, and a
+// vector prefix scan over the per-window row xors did no better.
+__attribute__((always_inline))
+static inline void rolling_roll4(const unsigned char *s, size_t c,
+                                 uint64_t *out, const rolling_t *k,
+                                 const int general) {
+    const unsigned char *in = s + k->n - 1;
+    const uint64_t *intab = k->intab;
+    const uint64_t *outtab = k->outtab;
+    // run r covers the windows r c to r c + c - 1; one base pointer and
+    // three offsets leave enough registers for the four hashes
+    const size_t c2 = 2 * c, c3 = 3 * c;
+    uint64_t h0 = rolling_window_impl(s, k, general);
+    uint64_t h1 = rolling_window_impl(s + c, k, general);
+    uint64_t h2 = rolling_window_impl(s + c2, k, general);
+    uint64_t h3 = rolling_window_impl(s + c3, k, general);
+    out[0] = h0;
+    out[c] = h1;
+    out[c2] = h2;
+    out[c3] = h3;
+    for (size_t t = 1; t < c; ++t) {
+        h0 = rolling_step(h0, general) ^ (outtab[s[t - 1]] ^ intab[in[t]]);
+        h1 = rolling_step(h1, general) ^
+             (outtab[s[t - 1 + c]] ^ intab[in[t + c]]);
+        h2 = rolling_step(h2, general) ^
+             (outtab[s[t - 1 + c2]] ^ intab[in[t + c2]]);
+        h3 = rolling_step(h3, general) ^
+             (outtab[s[t - 1 + c3]] ^ intab[in[t + c3]]);
+        out[t] = h0;
+        out[t + c] = h1;
+        out[t + c2] = h2;
+        out[t + c3] = h3;
+    }
+}
+
+__attribute__((always_inline))
+static inline void rolling_hash_impl(const unsigned char *s, size_t len,
+                                     uint64_t *out, const rolling_t *k,
+                                     const int general) {
+    const size_t windows = len - k->n + 1;
+    const size_t c = windows / 4;
+    size_t w = 1;
+    if (c >= 64 && c >= k->n) {
+        rolling_roll4(s, c, out, k, general);
+        w = 4 * c;
+    } else {
+        out[0] = rolling_window_impl(s, k, general);
+    }
+    rolling_roll(s, w, windows, out[w - 1], out, k, general);
+}
+
+// out[i] is the hash of the window s[i .. i + n - 1], for the len - n + 1
+// windows of s (none if len < n)
+void rolling_hash(const unsigned char *s, size_t len, uint64_t *out,
+                  const rolling_t *k) {
+    if (len < k->n) return;
+    if (k->general) {
+        rolling_hash_impl(s, len, out, k, 1);
+    } else {
+        rolling_hash_impl(s, len, out, k, 0);
+    }
+}
+
+#if defined(__AVX512VBMI__)
+// the 8 x 8 transpose of the 64-bit lanes of r[0 .. 7]
+__attribute__((always_inline))
+static inline void rolling_transpose_epi64(__m512i *r) {
+    __m512i a[8], b[8];
+    for (int i = 0; i < 4; ++i) {
+        a[2 * i] = _mm512_unpacklo_epi64(r[2 * i], r[2 * i + 1]);
+        a[2 * i + 1] = _mm512_unpackhi_epi64(r[2 * i], r[2 * i + 1]);
+    }
+    const __m512i lo = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+    const __m512i hi = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            b[4 * i + j] =
+                _mm512_permutex2var_epi64(a[4 * i + j], lo, a[4 * i + 2 + j]);
+            b[4 * i + 2 + j] =
+                _mm512_permutex2var_epi64(a[4 * i + j], hi, a[4 * i + 2 + j]);
+        }
+    }
+    for (int j = 0; j < 4; ++j) {
+        r[j] = _mm512_shuffle_i64x2(b[j], b[4 + j], 0x44);
+        r[4 + j] = _mm512_shuffle_i64x2(b[j], b[4 + j], 0xEE);
+    }
+}
+
+// s[b] holds byte b of the row (i, t) at byte 8 i + t; q[t] gets the row
+// (i, t) in lane i
+__attribute__((always_inline))
+static inline void rolling_transpose_epi8(const __m512i *s, __m512i *q) {
+    __m512i a[8], b[2][2][2], c[2][4];
+    for (int j = 0; j < 4; ++j) {
+        a[2 * j] = _mm512_unpacklo_epi8(s[2 * j], s[2 * j + 1]);
+        a[2 * j + 1] = _mm512_unpackhi_epi8(s[2 * j], s[2 * j + 1]);
+    }
+    // index p: the rows of the even (p = 0) or the odd (p = 1) lanes
+    for (int p = 0; p < 2; ++p) {
+        for (int j = 0; j < 2; ++j) {
+            b[p][j][0] = _mm512_unpacklo_epi16(a[4 * j + p], a[4 * j + 2 + p]);
+            b[p][j][1] = _mm512_unpackhi_epi16(a[4 * j + p], a[4 * j + 2 + p]);
+        }
+        for (int h = 0; h < 2; ++h) {
+            c[p][2 * h] = _mm512_unpacklo_epi32(b[p][0][h], b[p][1][h]);
+            c[p][2 * h + 1] = _mm512_unpackhi_epi32(b[p][0][h], b[p][1][h]);
+        }
+    }
+    for (int t = 0; t < 4; ++t) {
+        q[2 * t] = _mm512_unpacklo_epi64(c[0][t], c[1][t]);
+        q[2 * t + 1] = _mm512_unpackhi_epi64(c[0][t], c[1][t]);
+    }
+}
+
+// acc ^ byte b of the rows of the 64 bytes of x, from the 256 bytes of
+// inbytes[b] or outbytes[b]; high is the mask of the bytes of x >= 128
+__attribute__((always_inline))
+static inline __m512i rolling_lookup_epi8(__m512i acc, const uint8_t *bytes,
+                                          __m512i x, __mmask64 high) {
+    const __m512i lo = _mm512_permutex2var_epi8(
+        _mm512_loadu_si512(bytes), x, _mm512_loadu_si512(bytes + 64));
+    const __m512i hi = _mm512_maskz_permutex2var_epi8(
+        high, _mm512_loadu_si512(bytes + 128), x,
+        _mm512_loadu_si512(bytes + 192));
+    return _mm512_ternarylogic_epi64(acc, lo, hi, 0x96);
+}
+
+__attribute__((always_inline))
+static inline __m512i rolling_step_epi64(__m512i h, const int general) {
+    if (!general) return _mm512_rol_epi64(h, 1);
+    const __m512i carry =
+        _mm512_and_si512(_mm512_srai_epi64(h, 63), _mm512_set1_epi64(0x1B));
+    return _mm512_xor_si512(_mm512_slli_epi64(h, 1), carry);
+}
+
+// rolling_hash_lanes, for 8 runs of c windows, c = 64 q + 1: after the first
+// window of each run, the steps go by blocks of 64 bytes per run
+__attribute__((always_inline))
+static inline void rolling_lanes(const unsigned char *s, size_t c,
+                                 uint64_t *out, const rolling_t *k,
+                                 const int general) {
+    const unsigned char *in = s + k->n - 1;
+    uint64_t first[8];
+    for (int r = 0; r < 8; ++r) {
+        first[r] = rolling_window_impl(s + r * c, k, general);
+        out[r * c] = first[r];
+    }
+    __m512i h = _mm512_loadu_si512(first);
+    for (size_t t0 = 0; t0 + 1 < c; t0 += 64) {
+        // xin[j] (xout[j]): the bytes entering (leaving) the windows
+        // t0 + 8 j + 1 to t0 + 8 j + 8 of run r in lane r
+        __m512i xin[8], xout[8];
+        for (int r = 0; r < 8; ++r) {
+            xin[r] = _mm512_loadu_si512(in + r * c + t0 + 1);
+            xout[r] = _mm512_loadu_si512(s + r * c + t0);
+        }
+        rolling_transpose_epi64(xin);
+        rolling_transpose_epi64(xout);
+        for (int j = 0; j < 8; ++j) {
+            const __mmask64 highin = _mm512_movepi8_mask(xin[j]);
+            const __mmask64 highout = _mm512_movepi8_mask(xout[j]);
+            __m512i bytes[8], rows[8];
+            for (int b = 0; b < 8; ++b) {
+                bytes[b] = rolling_lookup_epi8(_mm512_setzero_si512(),
+                                               k->inbytes[b], xin[j], highin);
+                bytes[b] = rolling_lookup_epi8(bytes[b], k->outbytes[b],
+                                               xout[j], highout);
+            }
+            rolling_transpose_epi8(bytes, rows);
+            for (int t = 0; t < 8; ++t) {
+                h = _mm512_xor_si512(rolling_step_epi64(h, general), rows[t]);
+                rows[t] = h;
+            }
+            rolling_transpose_epi64(rows);
+            for (int r = 0; r < 8; ++r) {
+                _mm512_storeu_si512(out + r * c + t0 + 8 * j + 1, rows[r]);
+            }
+        }
+    }
+}
+#endif
+
+__attribute__((always_inline))
+static inline void rolling_hash_lanes_impl(const unsigned char *s, size_t len,
+                                           uint64_t *out, const rolling_t *k,
+                                           const int general) {
+    const size_t windows = len - k->n + 1;
+#if defined(__AVX512VBMI__)
+    const size_t q = windows / 8 >= 65 ? (windows / 8 - 1) / 64 : 0;
+    if (q > 0 && 64 * q + 1 >= k->n) {
+        const size_t c = 64 * q + 1;
+        rolling_lanes(s, c, out, k, general);
+        rolling_roll(s, 8 * c, windows, out[8 * c - 1], out, k, general);
+        return;
+    }
+#endif
+    rolling_hash_impl(s, len, out, k, general);
+}
+
+// Same as rolling_hash, with the runs in the 8 lanes of a 512-bit register
+// (AVX-512 VBMI; elsewhere, rolling_hash itself). The table rows are looked up
+// in registers by vpermi2b, one byte of the rows at a time for 64 bytes of
+// input, so there are no gathers, but the bytes must be transposed into rows
+// and the hashes back into the runs. Measured on a 16 KB buffer it takes
+// 1.6 (cyclic) and 1.7 (general) TSC cycles per byte against 1.2 and 1.6 for
+// rolling_hash, which is why rolling_hash keeps the scalar runs.
+void rolling_hash_lanes(const unsigned char *s, size_t len, uint64_t *out,
+                        const rolling_t *k) {
+    if (len < k->n) return;
+    if (k->general) {
+        rolling_hash_lanes_impl(s, len, out, k, 1);
+    } else {
+        rolling_hash_lanes_impl(s, len, out, k, 0);
+    }
+}
+
+#endif
@@ -0,0 +1,351 @@
+#ifndef SHORTHASH_SIMD_H
+#define SHORTHASH_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// GCC 12 warns about the _mm512_undefined_* placeholders inside its own
+// AVX-512 intrinsics once they are inlined into the kernels. The warnings
+// point into the intrinsic headers, so they are silenced there only.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+#include <immintrin.h> // x86 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/**
+* Helpers shared by the batch kernels (the *_batch functions that hash n
+* words at once). Each kernel picks the widest path enabled at compile time
+* (AVX-512, then AVX2) and finishes the tail with the scalar function.
+*/
+
+#ifdef __AVX2__
+// low 64 bits of the lane-wise 64x64 product
+__attribute__((always_inline))
+static inline __m256i mullo64_si256(__m256i a, __m256i b) {
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+    return _mm256_mullo_epi64(a, b);
+#else
+    // a_lo * b_lo + ((a_lo * b_hi + a_hi * b_lo) << 32), from 32x32 products
+    const __m256i bswap = _mm256_shuffle_epi32(b, 0xB1);
+    const __m256i cross = _mm256_mullo_epi32(a, bswap);
+    const __m256i crosssum = _mm256_add_epi32(cross, _mm256_srli_epi64(cross, 32));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b),
+                            _mm256_slli_epi64(crosssum, 32));
+#endif
+}
+#endif
+
+#ifdef __AVX2__
+// high 64 bits of the lane-wise unsigned 64x64 product, from 32x32 products
+__attribute__((always_inline))
+static inline __m256i mulhi64_si256(__m256i a, __m256i b) {
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i ahi = _mm256_srli_epi64(a, 32);
+    const __m256i bhi = _mm256_srli_epi64(b, 32);
+    const __m256i lolo = _mm256_mul_epu32(a, b);
+    const __m256i t = _mm256_add_epi64(_mm256_mul_epu32(ahi, b),
+                                       _mm256_srli_epi64(lolo, 32));
+    const __m256i w = _mm256_add_epi64(_mm256_and_si256(t, low),
+                                       _mm256_mul_epu32(a, bhi));
+    return _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(ahi, bhi), _mm256_srli_epi64(t, 32)),
+        _mm256_srli_epi64(w, 32));
+}
+#endif
+
+#ifdef __AVX2__
+// both halves of the lane-wise unsigned 64x64 product: returns the high 64
+// bits and stores the low 64 bits in *lo
+__attribute__((always_inline))
+static inline __m256i mul64_si256(__m256i a, __m256i b, __m256i *lo) {
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i ahi = _mm256_srli_epi64(a, 32);
+    const __m256i bhi = _mm256_srli_epi64(b, 32);
+    const __m256i lolo = _mm256_mul_epu32(a, b);
+    const __m256i t = _mm256_add_epi64(_mm256_mul_epu32(ahi, b),
+                                       _mm256_srli_epi64(lolo, 32));
+    const __m256i w = _mm256_add_epi64(_mm256_and_si256(t, low),
+                                       _mm256_mul_epu32(a, bhi));
+    *lo = _mm256_or_si256(_mm256_slli_epi64(w, 32), _mm256_and_si256(lolo, low));
+    return _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(ahi, bhi), _mm256_srli_epi64(t, 32)),
+        _mm256_srli_epi64(w, 32));
+}
+#endif
+
+#ifdef __AVX2__
+// h ^ (h >> shift) on each 64-bit lane, for a shift known only at run time
+__attribute__((always_inline))
+static inline __m256i xorshift_epi64_si256(__m256i h, int shift) {
+    return _mm256_xor_si256(h, _mm256_srl_epi64(h, _mm_cvtsi32_si128(shift)));
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i xorshift_epi64_si512(__m512i h, int shift) {
+    return _mm512_xor_si512(h, _mm512_srl_epi64(h, _mm_cvtsi32_si128(shift)));
+}
+#endif
+
+#ifdef __AVX2__
+// h ^ (h >> shift) on each 32-bit lane
+__attribute__((always_inline))
+static inline __m256i xorshift_epi32_si256(__m256i h, int shift) {
+    return _mm256_xor_si256(h, _mm256_srl_epi32(h, _mm_cvtsi32_si128(shift)));
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i xorshift_epi32_si512(__m512i h, int shift) {
+    return _mm512_xor_si512(h, _mm512_srl_epi32(h, _mm_cvtsi32_si128(shift)));
+}
+#endif
+
+#ifdef __AVX2__
+// rotate each 64-bit lane left by b, 0 < b < 64; a half swap when b is 32
+__attribute__((always_inline))
+static inline __m256i rotl_epi64_si256(__m256i x, int b) {
+    if (b == 32) return _mm256_shuffle_epi32(x, 0xB1);
+    return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128(b)),
+                           _mm256_srl_epi64(x, _mm_cvtsi32_si128(64 - b)));
+}
+
+// rotate each 32-bit lane left by b, 0 < b < 32
+__attribute__((always_inline))
+static inline __m256i rotl_epi32_si256(__m256i x, int b) {
+    return _mm256_or_si256(_mm256_sll_epi32(x, _mm_cvtsi32_si128(b)),
+                           _mm256_srl_epi32(x, _mm_cvtsi32_si128(32 - b)));
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i rotl_epi64_si512(__m512i x, int b) {
+    return _mm512_rolv_epi64(x, _mm512_set1_epi64(b));
+}
+
+__attribute__((always_inline))
+static inline __m512i rotl_epi32_si512(__m512i x, int b) {
+    return _mm512_rolv_epi32(x, _mm512_set1_epi32(b));
+}
+#endif
+
+// 32-bit keys hashed with 64-bit arithmetic: a vector of 2 * lanes keys is
+// viewed as the even keys (low halves, vpmuludq ignores the high halves) and
+// the odd keys (shifted down). The store keeps the low 32 bits of each result
+// and interleaves them back.
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline void load_even_odd_epu32_si256(const uint32_t *in, __m256i *even,
+                                             __m256i *odd) {
+    *even = _mm256_loadu_si256((const __m256i *)in);
+    *odd = _mm256_srli_epi64(*even, 32);
+}
+
+__attribute__((always_inline))
+static inline void store_even_odd_epu32_si256(uint32_t *out, __m256i even,
+                                              __m256i odd) {
+    _mm256_storeu_si256((__m256i *)out,
+                        _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA));
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline void load_even_odd_epu32_si512(const uint32_t *in, __m512i *even,
+                                             __m512i *odd) {
+    *even = _mm512_loadu_si512(in);
+    *odd = _mm512_srli_epi64(*even, 32);
+}
+
+__attribute__((always_inline))
+static inline void store_even_odd_epu32_si512(uint32_t *out, __m512i even,
+                                              __m512i odd) {
+    _mm512_storeu_si512(out, _mm512_mask_blend_epi32(0xAAAA, even,
+                                                     _mm512_slli_epi64(odd, 32)));
+}
+#endif
+
+#ifdef __AVX2__
+// shuffle control moving byte j of each 64-bit lane (width bytes wide) to the
+// bottom of the lane and zeroing the rest
+__attribute__((always_inline))
+static inline __m128i char_shuffle_si128(int j, int width) {
+    uint64_t lo = UINT64_C(0x8080808080808080), hi = lo;
+    for (int b = 0; b < width; ++b) {
+        lo ^= (uint64_t)(0x80 | (j + b)) << (8 * b);
+        hi ^= (uint64_t)(0x80 | (8 + j + b)) << (8 * b);
+    }
+    return _mm_set_epi64x(hi, lo);
+}
+
+// byte j (counting from the least significant) of each 64-bit lane
+__attribute__((always_inline))
+static inline __m256i byte_epi64_si256(__m256i x, int j) {
+    return _mm256_shuffle_epi8(x,
+                               _mm256_broadcastsi128_si256(char_shuffle_si128(j, 1)));
+}
+
+// 16-bit character j of each 64-bit lane
+__attribute__((always_inline))
+static inline __m256i short_epi64_si256(__m256i x, int j) {
+    return _mm256_shuffle_epi8(x,
+                               _mm256_broadcastsi128_si256(char_shuffle_si128(2 * j, 2)));
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+__attribute__((always_inline))
+static inline __m512i byte_epi64_si512(__m512i x, int j) {
+    return _mm512_shuffle_epi8(x,
+                               _mm512_broadcast_i32x4(char_shuffle_si128(j, 1)));
+}
+
+__attribute__((always_inline))
+static inline __m512i short_epi64_si512(__m512i x, int j) {
+    return _mm512_shuffle_epi8(x,
+                               _mm512_broadcast_i32x4(char_shuffle_si128(2 * j, 2)));
+}
+#endif
+
+// Carry-less products on 256/512-bit registers (VPCLMULQDQ)
+#if defined(__VPCLMULQDQ__) && defined(__AVX512F__) && defined(__AVX512BW__)
+#define SHORTHASH_VPCLMUL512
+#elif defined(__VPCLMULQDQ__) && defined(__AVX2__)
+#define SHORTHASH_VPCLMUL256
+#endif
+
+// Kernels built on 128-bit operations (carry-less products) keep one key per
+// 128-bit lane, in the low 64 bits with the high 64 bits zeroed, so that each
+// lane mirrors the scalar code. The load splits 2 * lanes consecutive keys into
+// the even-indexed and the odd-indexed ones; the store takes the low 64 bits
+// of each lane back to the original order.
+#ifdef __AVX2__
+__attribute__((always_inline))
+static inline void load_split_epi64_si256(const uint64_t *in, __m256i *even,
+                                          __m256i *odd) {
+    const __m256i x = _mm256_loadu_si256((const __m256i *)in);
+    *even = _mm256_unpacklo_epi64(x, _mm256_setzero_si256());
+    *odd = _mm256_unpackhi_epi64(x, _mm256_setzero_si256());
+}
+
+__attribute__((always_inline))
+static inline void store_merge_epi64_si256(uint64_t *out, __m256i even,
+                                           __m256i odd) {
+    _mm256_storeu_si256((__m256i *)out, _mm256_unpacklo_epi64(even, odd));
+}
+
+// same for 32-bit keys, which are zero-extended to 64 bits
+__attribute__((always_inline))
+static inline void load_split_epu32_si256(const uint32_t *in, __m256i *even,
+                                          __m256i *odd) {
+    const __m256i x =
+        _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)in));
+    *even = _mm256_unpacklo_epi64(x, _mm256_setzero_si256());
+    *odd = _mm256_unpackhi_epi64(x, _mm256_setzero_si256());
+}
+
+// low 32 bits of each 64-bit lane, packed
+__attribute__((always_inline))
+static inline __m128i cvtepi64_epi32_si256(__m256i x) {
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+        x, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+__attribute__((always_inline))
+static inline void store_merge_epi32_si256(uint32_t *out, __m256i even,
+                                           __m256i odd) {
+    _mm_storeu_si128((__m128i *)out,
+                     cvtepi64_epi32_si256(_mm256_unpacklo_epi64(even, odd)));
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline void load_split_epi64_si512(const uint64_t *in, __m512i *even,
+                                          __m512i *odd) {
+    const __m512i x = _mm512_loadu_si512(in);
+    *even = _mm512_unpacklo_epi64(x, _mm512_setzero_si512());
+    *odd = _mm512_unpackhi_epi64(x, _mm512_setzero_si512());
+}
+
+__attribute__((always_inline))
+static inline void store_merge_epi64_si512(uint64_t *out, __m512i even,
+                                           __m512i odd) {
+    _mm512_storeu_si512(out, _mm512_unpacklo_epi64(even, odd));
+}
+
+__attribute__((always_inline))
+static inline void load_split_epu32_si512(const uint32_t *in, __m512i *even,
+                                          __m512i *odd) {
+    const __m512i x =
+        _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)in));
+    *even = _mm512_unpacklo_epi64(x, _mm512_setzero_si512());
+    *odd = _mm512_unpackhi_epi64(x, _mm512_setzero_si512());
+}
+
+__attribute__((always_inline))
+static inline void store_merge_epi32_si512(uint32_t *out, __m512i even,
+                                           __m512i odd) {
+    _mm256_storeu_si256((__m256i *)out,
+                        _mm512_cvtepi64_epi32(_mm512_unpacklo_epi64(even, odd)));
+}
+#endif
+
+#ifdef __AVX512F__
+// low 64 bits of the lane-wise 64x64 product
+__attribute__((always_inline))
+static inline __m512i mullo64_si512(__m512i a, __m512i b) {
+#ifdef __AVX512DQ__
+    return _mm512_mullo_epi64(a, b);
+#else
+    const __m512i bswap = _mm512_shuffle_epi32(b, _MM_PERM_CDAB);
+    const __m512i cross = _mm512_mullo_epi32(a, bswap);
+    const __m512i crosssum = _mm512_add_epi32(cross, _mm512_srli_epi64(cross, 32));
+    return _mm512_add_epi64(_mm512_mul_epu32(a, b),
+                            _mm512_slli_epi64(crosssum, 32));
+#endif
+}
+#endif
+
+#ifdef __AVX512F__
+__attribute__((always_inline))
+static inline __m512i mul64_si512(__m512i a, __m512i b, __m512i *lo) {
+    const __m512i low = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i ahi = _mm512_srli_epi64(a, 32);
+    const __m512i bhi = _mm512_srli_epi64(b, 32);
+    const __m512i lolo = _mm512_mul_epu32(a, b);
+    const __m512i t = _mm512_add_epi64(_mm512_mul_epu32(ahi, b),
+                                       _mm512_srli_epi64(lolo, 32));
+    const __m512i w = _mm512_add_epi64(_mm512_and_si512(t, low),
+                                       _mm512_mul_epu32(a, bhi));
+    *lo = _mm512_or_si512(_mm512_slli_epi64(w, 32), _mm512_and_si512(lolo, low));
+    return _mm512_add_epi64(
+        _mm512_add_epi64(_mm512_mul_epu32(ahi, bhi), _mm512_srli_epi64(t, 32)),
+        _mm512_srli_epi64(w, 32));
+}
+
+__attribute__((always_inline))
+static inline __m512i mulhi64_si512(__m512i a, __m512i b) {
+    const __m512i low = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i ahi = _mm512_srli_epi64(a, 32);
+    const __m512i bhi = _mm512_srli_epi64(b, 32);
+    const __m512i lolo = _mm512_mul_epu32(a, b);
+    const __m512i t = _mm512_add_epi64(_mm512_mul_epu32(ahi, b),
+                                       _mm512_srli_epi64(lolo, 32));
+    const __m512i w = _mm512_add_epi64(_mm512_and_si512(t, low),
+                                       _mm512_mul_epu32(a, bhi));
+    return _mm512_add_epi64(
+        _mm512_add_epi64(_mm512_mul_epu32(ahi, bhi), _mm512_srli_epi64(t, 32)),
+        _mm512_srli_epi64(w, 32));
+}
+#endif
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+/**
+* SipHash specialized to a single 8-byte (or 16-byte) word, and HalfSipHash
+* specialized to a single 4-byte word, by Jean-Philippe Aumasson and Daniel J.
+* Bernstein.
+* https://github.com/veorq/SipHash
+*
+* These follow the reference specification (the final block carries the
+* message length), so siphash24_u64(x) equals SipHash-2-4 of the 8
+* little-endian bytes of x. The batch kernels hash 8 (AVX-512) or 4 (AVX2)
+* independent words per vector, one per lane.
+*/
+
+#include "simd.h"
+#include "util.h"
+
+typedef struct {
+  uint64_t k0;
+  uint64_t k1;
+} siphash_key_t;
+
+void siphash_key_init(siphash_key_t *key) {
+  key->k0 = get64rand();
+  key->k1 = get64rand();
+}
+
+typedef struct {
+  uint32_t k0;
+  uint32_t k1;
+} halfsiphash_key_t;
+
+void halfsiphash_key_init(halfsiphash_key_t *key) {
+  key->k0 = get32rand();
+  key->k1 = get32rand();
+}
+
+// One SipRound over any representation of the state; the six rotation
+// counts are (13, 32, 16, 21, 17, 32) for SipHash and (5, 16, 8, 7, 13, 16)
+// for HalfSipHash.
+#define SIP_ROUND(ADD, XOR, ROTL, v0, v1, v2, v3, r1, r2, r3, r4, r5, r6)     \
+  do {                                                                         \
+    v0 = ADD(v0, v1); v1 = ROTL(v1, r1); v1 = XOR(v1, v0); v0 = ROTL(v0, r2); \
+    v2 = ADD(v2, v3); v3 = ROTL(v3, r3); v3 = XOR(v3, v2);                    \
+    v0 = ADD(v0, v3); v3 = ROTL(v3, r4); v3 = XOR(v3, v0);                    \
+    v2 = ADD(v2, v1); v1 = ROTL(v1, r5); v1 = XOR(v1, v2); v2 = ROTL(v2, r6); \
+  } while (0)
+
+#define SIP_ADD(a, b) ((a) + (b))
+#define SIP_XOR(a, b) ((a) ^ (b))
+#define SIP_ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROTL32(x, b) (uint32_t)(((x) << (b)) | ((x) >> (32 - (b))))
+
+#define SIPROUND64(ADD, XOR, ROTL, v0, v1, v2, v3) \
+  SIP_ROUND(ADD, XOR, ROTL, v0, v1, v2, v3, 13, 32, 16, 21, 17, 32)
+#define SIPROUND32(ADD, XOR, ROTL, v0, v1, v2, v3) \
+  SIP_ROUND(ADD, XOR, ROTL, v0, v1, v2, v3, 5, 16, 8, 7, 13, 16)
+
+// last block of an 8-byte (resp. 4-byte) message: only the length byte
+#define SIPHASH_LAST_BLOCK (UINT64_C(8) << 56)
+#define HALFSIPHASH_LAST_BLOCK (UINT32_C(4) << 24)
+#define SIPHASH128_LAST_BLOCK (UINT64_C(16) << 56)
+
+__attribute__((always_inline))
+inline uint64_t siphash_u64(uint64_t m, const siphash_key_t *key,
+                            const int crounds, const int drounds) {
+  uint64_t v0 = key->k0 ^ UINT64_C(0x736f6d6570736575);
+  uint64_t v1 = key->k1 ^ UINT64_C(0x646f72616e646f6d);
+  uint64_t v2 = key->k0 ^ UINT64_C(0x6c7967656e657261);
+  uint64_t v3 = key->k1 ^ UINT64_C(0x7465646279746573);
+  v3 ^= m;
+  for (int i = 0; i < crounds; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  v0 ^= m;
+  v3 ^= SIPHASH_LAST_BLOCK;
+  for (int i = 0; i < crounds; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  v0 ^= SIPHASH_LAST_BLOCK;
+  v2 ^= 0xff;
+  for (int i = 0; i < drounds; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+__attribute__((always_inline))
+inline uint64_t siphash24_u64(uint64_t m, const siphash_key_t *key) {
+  return siphash_u64(m, key, 2, 4);
+}
+
+__attribute__((always_inline))
+inline uint64_t siphash13_u64(uint64_t m, const siphash_key_t *key) {
+  return siphash_u64(m, key, 1, 3);
+}
+
+// SipHash-2-4 of the 16 little-endian bytes of a 128-bit key (UUIDs, IPv6
+// addresses): two message blocks, then the length block. The 64-bit hash is
+// in the low half of the result.
+__attribute__((always_inline))
+inline uint128_t siphash24_u128(uint128_t m, const siphash_key_t *key) {
+  const uint64_t m0 = (uint64_t)m, m1 = (uint64_t)(m >> 64);
+  uint64_t v0 = key->k0 ^ UINT64_C(0x736f6d6570736575);
+  uint64_t v1 = key->k1 ^ UINT64_C(0x646f72616e646f6d);
+  uint64_t v2 = key->k0 ^ UINT64_C(0x6c7967656e657261);
+  uint64_t v3 = key->k1 ^ UINT64_C(0x7465646279746573);
+  v3 ^= m0;
+  for (int i = 0; i < 2; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  v0 ^= m0;
+  v3 ^= m1;
+  for (int i = 0; i < 2; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  v0 ^= m1;
+  v3 ^= SIPHASH128_LAST_BLOCK;
+  for (int i = 0; i < 2; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  v0 ^= SIPHASH128_LAST_BLOCK;
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; ++i)
+    SIPROUND64(SIP_ADD, SIP_XOR, SIP_ROTL64, v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// HalfSipHash-2-4 with a 32-bit output
+__attribute__((always_inline))
+inline uint32_t halfsiphash24_u32(uint32_t m, const halfsiphash_key_t *key) {
+  uint32_t v0 = key->k0;
+  uint32_t v1 = key->k1;
+  uint32_t v2 = key->k0 ^ UINT32_C(0x6c796765);
+  uint32_t v3 = key->k1 ^ UINT32_C(0x74656462);
+  v3 ^= m;
+  for (int i = 0; i < 2; ++i)
+    SIPROUND32(SIP_ADD, SIP_XOR, SIP_ROTL32, v0, v1, v2, v3);
+  v0 ^= m;
+  v3 ^= HALFSIPHASH_LAST_BLOCK;
+  for (int i = 0; i < 2; ++i)
+    SIPROUND32(SIP_ADD, SIP_XOR, SIP_ROTL32, v0, v1, v2, v3);
+  v0 ^= HALFSIPHASH_LAST_BLOCK;
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; ++i)
+    SIPROUND32(SIP_ADD, SIP_XOR, SIP_ROTL32, v0, v1, v2, v3);
+  return v1 ^ v3;
+}
+
+// The vector versions replay the scalar code above on whole registers.
+#if defined(__AVX512F__)
+#define SIP_VEC __m512i
+#define SIP_VEC_LANES64 8
+#define SIP_VEC_ADD64 _mm512_add_epi64
+#define SIP_VEC_ADD32 _mm512_add_epi32
+#define SIP_VEC_XOR _mm512_xor_si512
+#define SIP_VEC_ROTL64 rotl_epi64_si512
+#define SIP_VEC_ROTL32 rotl_epi32_si512
+#define SIP_VEC_SET64(x) _mm512_set1_epi64(x)
+#define SIP_VEC_SET32(x) _mm512_set1_epi32(x)
+#define SIP_VEC_LOAD(p) _mm512_loadu_si512(p)
+#define SIP_VEC_STORE(p, x) _mm512_storeu_si512(p, x)
+#define SIP_VEC_UNPACKLO64 _mm512_unpacklo_epi64
+#define SIP_VEC_UNPACKHI64 _mm512_unpackhi_epi64
+#define SIP_VEC_ZERO() _mm512_setzero_si512()
+#elif defined(__AVX2__)
+#define SIP_VEC __m256i
+#define SIP_VEC_LANES64 4
+#define SIP_VEC_ADD64 _mm256_add_epi64
+#define SIP_VEC_ADD32 _mm256_add_epi32
+#define SIP_VEC_XOR _mm256_xor_si256
+#define SIP_VEC_ROTL64 rotl_epi64_si256
+#define SIP_VEC_ROTL32 rotl_epi32_si256
+#define SIP_VEC_SET64(x) _mm256_set1_epi64x(x)
+#define SIP_VEC_SET32(x) _mm256_set1_epi32(x)
+#define SIP_VEC_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define SIP_VEC_STORE(p, x) _mm256_storeu_si256((__m256i *)(p), x)
+#define SIP_VEC_UNPACKLO64 _mm256_unpacklo_epi64
+#define SIP_VEC_UNPACKHI64 _mm256_unpackhi_epi64
+#define SIP_VEC_ZERO() _mm256_setzero_si256()
+#endif
+
+__attribute__((always_inline))
+inline void siphash_batch(const uint64_t *in, uint64_t *out, size_t n,
+                          const siphash_key_t *key, const int crounds,
+                          const int drounds) {
+  size_t i = 0;
+#ifdef SIP_VEC
+  const SIP_VEC k0 = SIP_VEC_SET64(key->k0);
+  const SIP_VEC k1 = SIP_VEC_SET64(key->k1);
+  const SIP_VEC c0 = SIP_VEC_XOR(k0, SIP_VEC_SET64(UINT64_C(0x736f6d6570736575)));
+  const SIP_VEC c1 = SIP_VEC_XOR(k1, SIP_VEC_SET64(UINT64_C(0x646f72616e646f6d)));
+  const SIP_VEC c2 = SIP_VEC_XOR(k0, SIP_VEC_SET64(UINT64_C(0x6c7967656e657261)));
+  const SIP_VEC c3 = SIP_VEC_XOR(k1, SIP_VEC_SET64(UINT64_C(0x7465646279746573)));
+  const SIP_VEC last = SIP_VEC_SET64(SIPHASH_LAST_BLOCK);
+  const SIP_VEC ff = SIP_VEC_SET64(0xff);
+  for (; i + SIP_VEC_LANES64 <= n; i += SIP_VEC_LANES64) {
+    const SIP_VEC m = SIP_VEC_LOAD(in + i);
+    SIP_VEC v0 = c0, v1 = c1, v2 = c2, v3 = SIP_VEC_XOR(c3, m);
+    for (int r = 0; r < crounds; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, m);
+    v3 = SIP_VEC_XOR(v3, last);
+    for (int r = 0; r < crounds; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, last);
+    v2 = SIP_VEC_XOR(v2, ff);
+    for (int r = 0; r < drounds; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    SIP_VEC_STORE(out + i, SIP_VEC_XOR(SIP_VEC_XOR(v0, v1), SIP_VEC_XOR(v2, v3)));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = siphash_u64(in[i], key, crounds, drounds);
+  }
+}
+
+void siphash24_batch(const uint64_t *in, uint64_t *out, size_t n,
+                     const siphash_key_t *key) {
+  siphash_batch(in, out, n, key, 2, 4);
+}
+
+void siphash13_batch(const uint64_t *in, uint64_t *out, size_t n,
+                     const siphash_key_t *key) {
+  siphash_batch(in, out, n, key, 1, 3);
+}
+
+// Two vectors of keys are unpacked into a vector of low limbs and one of high
+// limbs (keys 0, h, 1, h + 1, ... for h keys per vector), and the hashes are
+// unpacked back next to zero high halves.
+void siphash24_u128_batch(const uint128_t *in, uint128_t *out, size_t n,
+                          const siphash_key_t *key) {
+  size_t i = 0;
+#ifdef SIP_VEC
+  const size_t half = SIP_VEC_LANES64 / 2;
+  const SIP_VEC k0 = SIP_VEC_SET64(key->k0);
+  const SIP_VEC k1 = SIP_VEC_SET64(key->k1);
+  const SIP_VEC c0 = SIP_VEC_XOR(k0, SIP_VEC_SET64(UINT64_C(0x736f6d6570736575)));
+  const SIP_VEC c1 = SIP_VEC_XOR(k1, SIP_VEC_SET64(UINT64_C(0x646f72616e646f6d)));
+  const SIP_VEC c2 = SIP_VEC_XOR(k0, SIP_VEC_SET64(UINT64_C(0x6c7967656e657261)));
+  const SIP_VEC c3 = SIP_VEC_XOR(k1, SIP_VEC_SET64(UINT64_C(0x7465646279746573)));
+  const SIP_VEC last = SIP_VEC_SET64(SIPHASH128_LAST_BLOCK);
+  const SIP_VEC ff = SIP_VEC_SET64(0xff);
+  for (; i + SIP_VEC_LANES64 <= n; i += SIP_VEC_LANES64) {
+    const SIP_VEC a = SIP_VEC_LOAD(in + i);
+    const SIP_VEC b = SIP_VEC_LOAD(in + i + half);
+    const SIP_VEC m0 = SIP_VEC_UNPACKLO64(a, b);
+    const SIP_VEC m1 = SIP_VEC_UNPACKHI64(a, b);
+    SIP_VEC v0 = c0, v1 = c1, v2 = c2, v3 = SIP_VEC_XOR(c3, m0);
+    for (int r = 0; r < 2; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, m0);
+    v3 = SIP_VEC_XOR(v3, m1);
+    for (int r = 0; r < 2; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, m1);
+    v3 = SIP_VEC_XOR(v3, last);
+    for (int r = 0; r < 2; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, last);
+    v2 = SIP_VEC_XOR(v2, ff);
+    for (int r = 0; r < 4; ++r)
+      SIPROUND64(SIP_VEC_ADD64, SIP_VEC_XOR, SIP_VEC_ROTL64, v0, v1, v2, v3);
+    const SIP_VEC h = SIP_VEC_XOR(SIP_VEC_XOR(v0, v1), SIP_VEC_XOR(v2, v3));
+    SIP_VEC_STORE(out + i, SIP_VEC_UNPACKLO64(h, SIP_VEC_ZERO()));
+    SIP_VEC_STORE(out + i + half, SIP_VEC_UNPACKHI64(h, SIP_VEC_ZERO()));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = siphash24_u128(in[i], key);
+  }
+}
+
+// 32-bit lanes, so twice as many words per vector as siphash_batch
+void halfsiphash24_batch(const uint32_t *in, uint32_t *out, size_t n,
+                         const halfsiphash_key_t *key) {
+  size_t i = 0;
+#ifdef SIP_VEC
+  const SIP_VEC c0 = SIP_VEC_SET32(key->k0);
+  const SIP_VEC c1 = SIP_VEC_SET32(key->k1);
+  const SIP_VEC c2 = SIP_VEC_SET32(key->k0 ^ UINT32_C(0x6c796765));
+  const SIP_VEC c3 = SIP_VEC_SET32(key->k1 ^ UINT32_C(0x74656462));
+  const SIP_VEC last = SIP_VEC_SET32(HALFSIPHASH_LAST_BLOCK);
+  const SIP_VEC ff = SIP_VEC_SET32(0xff);
+  for (; i + 2 * SIP_VEC_LANES64 <= n; i += 2 * SIP_VEC_LANES64) {
+    const SIP_VEC m = SIP_VEC_LOAD(in + i);
+    SIP_VEC v0 = c0, v1 = c1, v2 = c2, v3 = SIP_VEC_XOR(c3, m);
+    for (int r = 0; r < 2; ++r)
+      SIPROUND32(SIP_VEC_ADD32, SIP_VEC_XOR, SIP_VEC_ROTL32, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, m);
+    v3 = SIP_VEC_XOR(v3, last);
+    for (int r = 0; r < 2; ++r)
+      SIPROUND32(SIP_VEC_ADD32, SIP_VEC_XOR, SIP_VEC_ROTL32, v0, v1, v2, v3);
+    v0 = SIP_VEC_XOR(v0, last);
+    v2 = SIP_VEC_XOR(v2, ff);
+    for (int r = 0; r < 4; ++r)
+      SIPROUND32(SIP_VEC_ADD32, SIP_VEC_XOR, SIP_VEC_ROTL32, v0, v1, v2, v3);
+    SIP_VEC_STORE(out + i, SIP_VEC_XOR(v1, v3));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = halfsiphash24_u32(in[i], key);
+  }
+}
+
+#endif // SIPHASH_H
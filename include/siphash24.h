@@ -1,7 +0,0 @@
-#ifndef __SIPHASH24
-#define __SIPHASH24
-
-int  siphash( uint8_t *out, const uint8_t *in, const uint8_t *k );
-
-
-#endif
@@ -1,6 +1,7 @@
 #ifndef SHORTHASH_UTIL_H
 #define SHORTHASH_UTIL_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -28,29 +29,115 @@ static uint64_t kbitreverse64 (uint64_t n) {
 }
 
 /**
-* As per the specification rand() returns an integer in [0, RAND_MAX] where
-* RAND_MAX>= 32767.
-* In Visual Studio, RAND_MAX is defined as 32767 or 15 bits so we cannot safely
-* assume that RAND_MAX is large.
+* All the randomness comes from a single splitmix64 stream (Steele, Lea and
+* Flood, Fast splittable pseudorandom number generators,
+* http://dx.doi.org/10.1145/2714064.2660195): word i of the stream is
+* splitmix64_mix(seed + (i + 1) * gamma). Being counter-based, any range of
+* the stream can be computed on its own, so large tables are filled with
+* straight-line (vectorizable) code and could be split across threads.
+*
+* The stream starts from a fixed seed, so runs are reproducible; call
+* seed64rand() to pick another one.
 */
+#define SPLITMIX64_GAMMA UINT64_C(0x9E3779B97F4A7C15)
+
+// position of the stream, i.e. seed + (words drawn so far) * gamma. Every
+// translation unit including this header defines it, weakly and with C
+// linkage, so the linker keeps one copy: C and C++ code, and the copies of
+// the headers that src/kernels.cpp wraps in a namespace, share one stream.
+#ifdef __cplusplus
+extern "C" {
+#endif
+__attribute__((weak)) uint64_t shorthash_rand_state = 0;
+#ifdef __cplusplus
+}
+#endif
+
+static inline uint64_t splitmix64_mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
+
+// out[i] = word i of the stream from state (the words after it, not
+// including it)
+static void splitmix64_fill(uint64_t state, uint64_t *out, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = splitmix64_mix(state + (i + 1) * SPLITMIX64_GAMMA);
+  }
+}
+
+static void seed64rand(uint64_t seed) {
+  shorthash_rand_state = seed;
+}
+
+// moves the stream to seed and returns where it was, so that one
+// initialization can draw from a seed of its own and leave the stream as it
+// found it:
+//   const uint64_t saved = swap64rand(seed);
+//   zobrist_init(&key);
+//   seed64rand(saved);
+static uint64_t swap64rand(uint64_t seed) {
+  const uint64_t saved = shorthash_rand_state;
+  shorthash_rand_state = seed;
+  return saved;
+}
+
+static uint64_t get64rand() {
+  shorthash_rand_state += SPLITMIX64_GAMMA;
+  return splitmix64_mix(shorthash_rand_state);
+}
+
 static uint32_t get8rand() {
-  return ((uint32_t) rand() ) & UINT32_C(0xFF);
+  return (uint32_t) get64rand() & UINT32_C(0xFF);
 }
 
 static uint32_t get16rand() {
-  return ((uint32_t) rand() ^ (uint32_t) rand() << 15) & UINT32_C(0xFFFF);
+  return (uint32_t) get64rand() & UINT32_C(0xFFFF);
 }
 
 static uint32_t get32rand() {
-    return ((uint32_t) rand() ^ ((uint32_t) rand() << 15) ^ ((uint32_t) rand() << 30));
+  return (uint32_t) get64rand();
 }
 
-static uint64_t get64rand() {
-    return (((uint64_t)get32rand()) << 32) | (uint32_t) get32rand();
+// the next n words of the stream, same as n calls to get64rand()
+static void fill64rand(uint64_t *out, size_t n) {
+  splitmix64_fill(shorthash_rand_state, out, n);
+  shorthash_rand_state += n * SPLITMIX64_GAMMA;
+}
+
+// same as n calls to get32rand()
+static void fill32rand(uint32_t *out, size_t n) {
+  const uint64_t state = shorthash_rand_state;
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = (uint32_t) splitmix64_mix(state + (i + 1) * SPLITMIX64_GAMMA);
+  }
+  shorthash_rand_state += n * SPLITMIX64_GAMMA;
 }
 
+// the high word first; the draws are sequenced explicitly since the order in
+// which operands are evaluated is unspecified
 static uint128_t get128rand() {
-    return (((uint128_t)get64rand()) << 64) | get64rand();
+    const uint64_t high = get64rand();
+    return (((uint128_t)high) << 64) | get64rand();
+}
+
+/**
+* The range kernels (*Range) hash the n keys start + i stride, i < n, taken
+* modulo 2^64 (2^32 for 32-bit keys). They only step from one key to the next
+* while the keys do not wrap around, so they work on the longest runs that
+* do not: range_nowrap64 is the length of the first one (at least 1 if n is).
+*/
+static inline size_t range_nowrap64(uint64_t start, uint64_t stride, size_t n) {
+  if (stride == 0) return n;
+  const uint64_t after = (UINT64_MAX - start) / stride; // keys after start
+  return after < n ? after + 1 : n;
+}
+
+static inline size_t range_nowrap32(uint32_t start, uint32_t stride, size_t n) {
+  if (stride == 0) return n;
+  const uint32_t after = (UINT32_MAX - start) / stride;
+  return after < n ? after + 1 : n;
 }
 
 #endif
@@ -2,6 +2,8 @@
 #ifndef WYHASH_H
 #define WYHASH_H
 
+#include "simd.h"
+
 
 void wyhash_init(uint64_t*) {
 
@@ -13,4 +15,41 @@ uint64_t wyhash(uint64_t state, const uint64_t*) {
     return (tmp >> 64) ^ tmp;
 }
 
+// wyhash_batch with the two multipliers given, for variants that pick their
+// own (they are loop invariants, so constants fold into the broadcasts)
+static inline void wyhash_mul_batch(const uint64_t *in, uint64_t *out,
+                                    size_t n, uint64_t multiplier1,
+                                    uint64_t multiplier2) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i m1 = _mm512_set1_epi64(multiplier1);
+    const __m512i m2 = _mm512_set1_epi64(multiplier2);
+    for (; i + 8 <= n; i += 8) {
+        const __m512i x = _mm512_loadu_si512(in + i);
+        const __m512i y = _mm512_xor_si512(mulhi64_si512(x, m1), mullo64_si512(x, m1));
+        _mm512_storeu_si512(out + i,
+                            _mm512_xor_si512(mulhi64_si512(y, m2), mullo64_si512(y, m2)));
+    }
+#elif defined(__AVX2__)
+    const __m256i m1 = _mm256_set1_epi64x(multiplier1);
+    const __m256i m2 = _mm256_set1_epi64x(multiplier2);
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        const __m256i y = _mm256_xor_si256(mulhi64_si256(x, m1), mullo64_si256(x, m1));
+        _mm256_storeu_si256((__m256i *)(out + i),
+                            _mm256_xor_si256(mulhi64_si256(y, m2), mullo64_si256(y, m2)));
+    }
+#endif
+    for (; i < n; ++i) {
+        __uint128_t tmp = (__uint128_t)(in[i])*multiplier1;
+        const uint64_t m = (tmp >> 64) ^ tmp;
+        tmp = (__uint128_t)m * multiplier2;
+        out[i] = (tmp >> 64) ^ tmp;
+    }
+}
+
+void wyhash_batch(const uint64_t *in, uint64_t *out, size_t n, const uint64_t*) {
+    wyhash_mul_batch(in, out, n, 0xa3b195354a39b70dull, 0x1b03738712fad5c9ull);
+}
+
 #endif
\ No newline at end of file
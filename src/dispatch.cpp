@@ -0,0 +1,77 @@
+// Picks the batch kernels of the best ISA level this CPU supports. This file
+// is built for the lowest level, like the programs that link it.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatch-families.h"
+
+namespace x86_64_v2 {
+extern const ShorthashBatchKernel kernels[SHORTHASH_NBR_KERNELS];
+}
+namespace x86_64_v3 {
+extern const ShorthashBatchKernel kernels[SHORTHASH_NBR_KERNELS];
+}
+namespace x86_64_v4 {
+extern const ShorthashBatchKernel kernels[SHORTHASH_NBR_KERNELS];
+}
+
+const ShorthashBatchKernel *ShorthashKernelsFor(ShorthashIsa isa) {
+    switch (isa) {
+    case ShorthashIsa::X86_64_V4:
+        return x86_64_v4::kernels;
+    case ShorthashIsa::X86_64_V3:
+        return x86_64_v3::kernels;
+    default:
+        return x86_64_v2::kernels;
+    }
+}
+
+const char *ShorthashIsaName(ShorthashIsa isa) {
+    switch (isa) {
+    case ShorthashIsa::X86_64_V4:
+        return "x86-64-v4";
+    case ShorthashIsa::X86_64_V3:
+        return "x86-64-v3";
+    default:
+        return "x86-64-v2";
+    }
+}
+
+// The feature checks match the -m flags the kernels are built with in the
+// Makefile: every level also needs PCLMUL for the CL families.
+ShorthashIsa ShorthashBestIsa() {
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("x86-64-v2") ||
+        !__builtin_cpu_supports("pclmul")) {
+        fprintf(stderr, "shorthash: needs at least x86-64-v2 with PCLMUL\n");
+        abort();
+    }
+    ShorthashIsa best = ShorthashIsa::X86_64_V2;
+    if (__builtin_cpu_supports("x86-64-v3")) {
+        best = ShorthashIsa::X86_64_V3;
+        if (__builtin_cpu_supports("x86-64-v4") &&
+            __builtin_cpu_supports("vpclmulqdq") &&
+            __builtin_cpu_supports("avx512ifma") &&
+            __builtin_cpu_supports("avx512vbmi") &&
+            __builtin_cpu_supports("gfni")) {
+            best = ShorthashIsa::X86_64_V4;
+        }
+    }
+    const char *wanted = getenv("SHORTHASH_ISA");
+    if (wanted != NULL) {
+        if (strcmp(wanted, "x86-64-v2") == 0) {
+            best = ShorthashIsa::X86_64_V2;
+        } else if (strcmp(wanted, "x86-64-v3") == 0 &&
+                   best == ShorthashIsa::X86_64_V4) {
+            best = ShorthashIsa::X86_64_V3;
+        }
+    }
+    return best;
+}
+
+const ShorthashBatchKernel *ShorthashKernels() {
+    static const ShorthashBatchKernel *const kernels =
+        ShorthashKernelsFor(ShorthashBestIsa());
+    return kernels;
+}
@@ -0,0 +1,63 @@
+// The batch kernels of the dispatched families, for one ISA level. This file
+// is compiled once per level, with the matching -march and
+// -DSHORTHASH_ISA=x86_64_v2 (or _v3, _v4); each copy of the hash headers
+// goes into its own namespace so that the levels link side by side.
+// the intrinsics with the warnings of GCC 12 silenced, as in simd.h
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#include <limits.h>
+#include <nmmintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef SHORTHASH_ISA
+#error "compile with -DSHORTHASH_ISA=<level>"
+#endif
+
+// util.h holds the random stream shared with the program, so it stays out of
+// the namespace (its include guard then skips the nested includes)
+#include "util.h"
+
+namespace SHORTHASH_ISA {
+#include "clhash.h"
+#include "cw-trick.h"
+#include "faster-cw-trick.h"
+#include "multiply-shift.h"
+#include "tabulated.h"
+#include "crc.h"
+#include "murmur.h"
+#include "javasplittable.h"
+#include "fnv.h"
+#include "linear.h"
+#include "identity.h"
+#include "oddmultiply.h"
+#include "siphash.h"
+#include "wyhash.h"
+}
+
+#include "dispatch-families.h"
+
+namespace SHORTHASH_ISA {
+#define SHORTHASH_KERNEL_THUNK(pack, word, randomness, batch)             \
+    static void pack##Kernel(const void *in, void *out, size_t n,         \
+                             const void *r) {                             \
+        batch(static_cast<const word *>(in), static_cast<word *>(out), n, \
+              static_cast<const randomness *>(r));                        \
+    }
+SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_KERNEL_THUNK)
+#undef SHORTHASH_KERNEL_THUNK
+
+#define SHORTHASH_KERNEL_ENTRY(pack, word, randomness, batch) pack##Kernel,
+extern const ShorthashBatchKernel kernels[SHORTHASH_NBR_KERNELS] = {
+    SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_KERNEL_ENTRY)};
+#undef SHORTHASH_KERNEL_ENTRY
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/tabulation.h"
+
+// Checks that HashBatch agrees with HashFunction, for every length up to
+// MAX_LENGTH so that the vector loops and the scalar tails are all exercised.
+struct Worker {
+    template <typename Pack>
+    static inline void Go(const size_t max_length, int nbr_trials,
+                          bool *buggy) {
+        typedef typename Pack::Word Word;
+        std::cout << "testing " << string(Pack::NAME) << std::endl;
+        seed64rand(0);
+        typename Pack::Randomness *randomness = new typename Pack::Randomness();
+        vector<Word> input(max_length), output(max_length);
+        for (int trial = 0; trial < nbr_trials; ++trial) {
+            Pack::InitRandomness(randomness);
+            for (auto &x : input) {
+                x = sizeof(Word) > sizeof(uint64_t) ? Word(get128rand())
+                                                    : Word(get64rand());
+            }
+            for (size_t length = 0; length <= max_length; ++length) {
+                Pack::HashBatch(input.data(), output.data(), length,
+                                randomness);
+                for (size_t i = 0; i < length; ++i) {
+                    if (output[i] != Pack::HashFunction(input[i], randomness)) {
+                        std::cout << string(Pack::NAME)
+                                  << " batch disagrees with scalar at index "
+                                  << i << " of " << length << std::endl;
+                        *buggy = true;
+                        delete randomness;
+                        return;
+                    }
+                }
+            }
+        }
+        // in-place hashing
+        vector<Word> inplace(input);
+        Pack::HashBatch(inplace.data(), inplace.data(), max_length, randomness);
+        for (size_t i = 0; i < max_length; ++i) {
+            if (inplace[i] != Pack::HashFunction(input[i], randomness)) {
+                std::cout << string(Pack::NAME) << " in-place batch is wrong"
+                          << std::endl;
+                *buggy = true;
+                break;
+            }
+        }
+        delete randomness;
+    }
+    static inline void Stop() {}
+};
+
+int main() {
+    const size_t max_length = 67;
+    const int nbr_trials = 4;
+    bool buggy = false;
+
+    ForEachT<Identity64Pack, Koloboke64Pack, RandomKoloboke64Pack,
+             RandomWeakKoloboke64Pack, BitMixing64Pack, ClBitMixing64Pack,
+             ReversedOddMultiply64Pack, FNV64Pack, JavaSplit64Pack,
+             Murmur64Pack, Stafford64Pack, xxHash64Pack, Wyhash64Pack,
+             CRC32_64Pack, CRCWide64Pack, Cyclic64Pack, Zobrist64Pack, WZobrist64Pack,
+             ZobristFlat64Pack, ZobristTranspose64Pack,
+             Twisted64Pack, DoubleTab64Pack, MixedTab64Pack<1>, MixedTab64Pack<>, MixedTab64Pack<8>,
+             TabulationPack<64, 8, 64>, TabulationPack<64, 11, 64>,
+             TabulationPack<64, 16, 64>, TabulationPack<64, 8, 32>,
+             TabulationPack<64, 11, 32>, TabulationPack<64, 16, 32>,
+             ThorupZhang64Pack, CompactThorupZhang64Pack, MultiplyShift64Pack,
+             UnivMultiplyShift64Pack, MultiplyTwice64Pack,
+             MultiplyThrice64Pack, ClLinear64Pack, ClQuadratic64Pack,
+             ClFastQuadratic64Pack, ClCubic64Pack, ClQuartic64Pack,
+             ThorupZhangCWLinear64Pack, ThorupZhangCWQuadratic64Pack,
+             ThorupZhangCWCubic64Pack, FasterCWLinear64Pack,
+             FasterCWQuadratic64Pack, FasterCWCubic64Pack, Linear64Pack,
+             Toeplitz64Pack,
+             SplitPack<MultiplyShift64Pack, MultiplyShift64Pack, 64>, SipPack,
+             Sip13Pack, HalfSip32Pack,
+             BitMixing64ConstPack<>, ClBitMixing64ConstPack<>,
+             Murmur64ConstPack<>, Koloboke64ConstPack<>, Wyhash64ConstPack<>,
+             Koloboke64ConstPack<ConstRandom64(1, 0) | 1, 29, 17>,
+             Wyhash64ConstPack<ConstRandom64(2, 0), ConstRandom64(2, 1)>,
+             Murmur32Pack, CRC32Pack, Cyclic32Pack, Zobrist32Pack,
+             WZobrist32Pack, MixedTab32Pack<1>, MixedTab32Pack<>,
+             TabulationPack<32, 8, 32>, TabulationPack<32, 11, 32>,
+             TabulationPack<32, 16, 32>,
+             ThorupZhang32Pack, MultiplyShift32Pack,
+             ClLinear32Pack, ClFastQuadratic32Pack, CWQuad32Pack,
+             ThorupZhangCWLinear32Pack, ThorupZhangCWQuadratic32Pack,
+             ThorupZhangCWCubic32Pack, ClLinear128Pack, ClQuadratic128Pack,
+             PairMultiplyShift128Pack, Zobrist128Pack,
+             Sip128Pack>::template Go<Worker>(max_length,
+                                                             nbr_trials,
+                                                             &buggy);
+    if (buggy) {
+        std::cout << "Batch hashing does not match scalar hashing."
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "Code ok." << std::endl;
+}
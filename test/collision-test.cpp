@@ -17,7 +17,7 @@ struct Worker {
                           const uint32_t mindistinct, int nbr_trials,
                           bool *buggy) {
         std::cout << "testing " << string(Pack::NAME) << std::endl;
-        srand(0);
+        seed64rand(0);
         uint8_t *bitset = new uint8_t[coverage / 8];
         size_t mincount = coverage;
         typename Pack::Randomness *randomness = new typename Pack::Randomness();
@@ -64,7 +64,7 @@ int main() {
     const int nbr_trials = 64;
     bool buggy = false;
 
-    ForEachT<Murmur32Pack, CRC32Pack, Murmur64Pack, CRC32_64Pack, Cyclic64Pack, Zobrist64Pack, WZobrist64Pack, ZobristTranspose64Pack,
+    ForEachT<Murmur32Pack, CRC32Pack, Murmur64Pack, CRC32_64Pack, CRCWide64Pack, Cyclic64Pack, Zobrist64Pack, WZobrist64Pack, ZobristTranspose64Pack,
              MultiplyShift64Pack, ClLinear64Pack, ClQuadratic64Pack,
              ClFastQuadratic64Pack, ClCubic64Pack,
              ClQuartic64Pack, ThorupZhangCWLinear64Pack,
@@ -72,7 +72,8 @@ int main() {
              Zobrist32Pack, WZobrist32Pack, MultiplyShift32Pack, ClLinear32Pack,
              ClFastQuadratic32Pack, CWQuad32Pack, ThorupZhangCWLinear32Pack,
              ThorupZhangCWQuadratic32Pack, ThorupZhangCWCubic32Pack,
-             ThorupZhang64Pack,
+             ThorupZhang64Pack, CompactThorupZhang64Pack, SipPack, Sip13Pack, HalfSip32Pack,
+             Twisted64Pack, DoubleTab64Pack, MixedTab64Pack<>, MixedTab32Pack<>,
              ThorupZhang32Pack>::template Go<Worker>(coverage, nbr_keys,
                                                      mindistinct, nbr_trials,
                                                      &buggy);
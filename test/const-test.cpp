@@ -0,0 +1,94 @@
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/hashpack.h"
+
+// Checks that a pack with template constants hashes like the runtime pack
+// whose randomness holds the same constants, one key at a time and in
+// batches (the length is not a multiple of the vector width, so the scalar
+// tails are covered too).
+template <typename ConstPack, typename Pack>
+static bool Check(const typename Pack::Randomness *r) {
+    cout << "testing " << string(ConstPack::NAME) << " against "
+         << string(Pack::NAME) << endl;
+    const size_t length = 1003;
+    vector<uint64_t> input(length), expected(length), output(length);
+    for (auto &x : input) x = get64rand();
+    input[0] = 0;
+    input[1] = UINT64_MAX;
+    const NoRandomness none;
+    for (size_t i = 0; i < length; ++i) {
+        expected[i] = Pack::HashFunction(input[i], r);
+        if (ConstPack::HashFunction(input[i], &none) != expected[i]) {
+            cout << string(ConstPack::NAME) << " disagrees with "
+                 << string(Pack::NAME) << " on " << input[i] << endl;
+            return false;
+        }
+    }
+    ConstPack::HashBatch(input.data(), output.data(), length, &none);
+    if (output != expected) {
+        cout << string(ConstPack::NAME) << " batch disagrees with "
+             << string(Pack::NAME) << endl;
+        return false;
+    }
+    return true;
+}
+
+// same, with the runtime pack's own constants
+template <typename ConstPack, typename Pack>
+static bool Check() {
+    typename Pack::Randomness r;
+    Pack::InitRandomness(&r);
+    return Check<ConstPack, Pack>(&r);
+}
+
+int main() {
+    bool ok = true;
+    seed64rand(0);
+    ok = Check<BitMixing64ConstPack<>, BitMixing64Pack>() && ok;
+    ok = Check<ClBitMixing64ConstPack<>, ClBitMixing64Pack>() && ok;
+    ok = Check<Murmur64ConstPack<>, Murmur64Pack>() && ok;
+    ok = Check<Koloboke64ConstPack<>, Koloboke64Pack>() && ok;
+    ok = Check<Wyhash64ConstPack<>, Wyhash64Pack>() && ok;
+    // other constants: the Stafford and xxHash variants of murmur64, and
+    // constants drawn at compile time from a seeded stream
+    ok = Check<Murmur64ConstPack<UINT64_C(0x7fb5d329728ea185),
+                                 UINT64_C(0x81dadef4bc2dd44d), 31, 27, 33>,
+               Stafford64Pack>() &&
+         ok;
+    ok = Check<Murmur64ConstPack<UINT64_C(4029467366897019727),
+                                 UINT64_C(1609587929392839161), 33, 29, 32>,
+               xxHash64Pack>() &&
+         ok;
+    seed64rand(1);
+    const uint64_t seeded = get64rand();
+    if (seeded != ConstRandom64(1, 0) || get64rand() != ConstRandom64(1, 1)) {
+        cout << "ConstRandom64 disagrees with get64rand" << endl;
+        ok = false;
+    }
+    koloboke_t kolo;
+    kolo.multiplier = seeded | 1;
+    kolo.shift1 = 29;
+    kolo.shift2 = 17;
+    ok = Check<Koloboke64ConstPack<ConstRandom64(1, 0) | 1, 29, 17>,
+               Koloboke64Pack>(&kolo) &&
+         ok;
+    bitmixing_t bm;
+    bm.multiplier = seeded;
+    ok = Check<BitMixing64ConstPack<ConstRandom64(1, 0)>, BitMixing64Pack>(
+             &bm) &&
+         ok;
+    cl_bitmixing_t clbm;
+    clbm.multiplier = _mm_cvtsi64_si128(seeded);
+    ok = Check<ClBitMixing64ConstPack<ConstRandom64(1, 0)>,
+               ClBitMixing64Pack>(&clbm) &&
+         ok;
+    if (!ok) {
+        cout << "Bugs found." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "Code ok." << endl;
+    return EXIT_SUCCESS;
+}
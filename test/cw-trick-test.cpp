@@ -5,6 +5,7 @@ using namespace std;
 
 extern "C" {
 #include "cw-trick.h"
+#include "faster-cw-trick.h"
 #include "util.h"
 }
 
@@ -13,6 +14,85 @@ ostream& cerr128(uint128_t x) {
                 << static_cast<uint64_t>((x << 64) >> 64);
 }
 
+// Big-integer references for the polynomial families: Horner's rule
+// h = h x + c modulo the prime with plain uint128_t arithmetic and %, the
+// 64-bit keys being multiplied in two 32-bit halves so that no product
+// exceeds 2^121.
+static const uint128_t P61 = (((uint128_t)1) << 61) - 1;
+static const uint128_t P89 = (((uint128_t)1) << 89) - 1;
+
+static uint128_t MulMod(uint128_t h, uint64_t x, uint128_t p) {
+    const uint128_t low = (h * (x & 0xFFFFFFFF)) % p;
+    const uint128_t high = (((h * (x >> 32)) % p) << 32) % p;
+    return (low + high) % p;
+}
+
+// coeffs[0] x^(count-1) + ... + coeffs[count-1] modulo p
+static uint128_t HornerReference(uint64_t x, const uint128_t *coeffs,
+                                 int count, uint128_t p) {
+    uint128_t h = coeffs[0] % p;
+    for (int j = 1; j < count; ++j) {
+        h = (MulMod(h, x, p) + coeffs[j]) % p;
+    }
+    return h;
+}
+
+static bool CheckCW32(uint32_t x) {
+    ThorupZhangCWLinear32_t l;
+    ThorupZhangCWQuadratic32_t q;
+    ThorupZhangCWCubic32_t c;
+    ThorupZhangCWLinear32Init(&l);
+    ThorupZhangCWQuadratic32Init(&q);
+    ThorupZhangCWCubic32Init(&c);
+    const uint128_t lc[2] = {l.A, l.B};
+    const uint128_t qc[3] = {q.A, q.B, q.C};
+    const uint128_t cc[4] = {c.A, c.B, c.C, c.D};
+    return ThorupZhangCWLinear32(x, &l) ==
+               (uint32_t)HornerReference(x, lc, 2, P61) &&
+           ThorupZhangCWQuadratic32(x, &q) ==
+               (uint32_t)HornerReference(x, qc, 3, P61) &&
+           ThorupZhangCWCubic32(x, &c) ==
+               (uint32_t)HornerReference(x, cc, 4, P61);
+}
+
+static bool CheckCW64(uint64_t x) {
+    ThorupZhangCWLinear64_t l;
+    ThorupZhangCWQuadratic64_t q;
+    ThorupZhangCWCubic64_t c;
+    ThorupZhangCWLinear64Init(&l);
+    ThorupZhangCWQuadratic64Init(&q);
+    ThorupZhangCWCubic64Init(&c);
+    const uint128_t lc[2] = {INT96Value(l.A), INT96Value(l.B)};
+    const uint128_t qc[3] = {INT96Value(q.A), INT96Value(q.B),
+                             INT96Value(q.C)};
+    const uint128_t cc[4] = {INT96Value(c.A), INT96Value(c.B),
+                             INT96Value(c.C), INT96Value(c.D)};
+    return ThorupZhangCWLinear64(x, &l) ==
+               (uint64_t)HornerReference(x, lc, 2, P89) &&
+           ThorupZhangCWQuadratic64(x, &q) ==
+               (uint64_t)HornerReference(x, qc, 3, P89) &&
+           ThorupZhangCWCubic64(x, &c) ==
+               (uint64_t)HornerReference(x, cc, 4, P89);
+}
+
+static bool CheckFasterCW64(uint64_t x) {
+    FasterCWLinear64_t l;
+    FasterCWQuadratic64_t q;
+    FasterCWCubic64_t c;
+    FasterCWLinear64Init(&l);
+    FasterCWQuadratic64Init(&q);
+    FasterCWCubic64Init(&c);
+    const uint128_t lc[2] = {l.A, l.B};
+    const uint128_t qc[3] = {q.A, q.B, q.C};
+    const uint128_t cc[4] = {c.A, c.B, c.C, c.D};
+    return FasterCWLinear64(x, &l) ==
+               (uint64_t)HornerReference(x, lc, 2, P89) &&
+           FasterCWQuadratic64(x, &q) ==
+               (uint64_t)HornerReference(x, qc, 3, P89) &&
+           FasterCWCubic64(x, &c) ==
+               (uint64_t)HornerReference(x, cc, 4, P89);
+}
+
 int main() {
     for (int i = 0; i < 50000000; ++i) {
         uint128_t x = get128rand() % ((CW_PRIME - 1) * (CW_PRIME - 1));
@@ -23,4 +103,24 @@ int main() {
             return 1;
         }
     }
+    // random coefficients for every key, with the extreme keys first
+    const uint64_t extremes[] = {0, 1, UINT32_MAX, UINT64_MAX};
+    for (int i = 0; i < 1000000; ++i) {
+        const uint64_t x = i < 4 ? extremes[i] : get64rand();
+        if (!CheckCW32((uint32_t)x)) {
+            cerr << "ThorupZhangCW*32 disagrees with the reference at 0x"
+                 << hex << (uint32_t)x << endl;
+            return 1;
+        }
+        if (!CheckCW64(x)) {
+            cerr << "ThorupZhangCW*64 disagrees with the reference at 0x"
+                 << hex << x << endl;
+            return 1;
+        }
+        if (!CheckFasterCW64(x)) {
+            cerr << "FasterCW*64 disagrees with the reference at 0x" << hex
+                 << x << endl;
+            return 1;
+        }
+    }
 }
@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/dispatch.h"
+
+// Checks that the kernels of every ISA level this CPU can run agree with the
+// scalar HashFunction (built for this program's -march), for every length up
+// to max_length.
+template <typename Pack>
+static bool Check(const ShorthashBatchKernel *kernels, size_t max_length) {
+    typedef typename Pack::Word Word;
+    seed64rand(0);
+    typename Pack::Randomness *randomness = new typename Pack::Randomness();
+    Pack::InitRandomness(randomness);
+    vector<Word> input(max_length), output(max_length);
+    for (auto &x : input) {
+        x = get64rand();
+    }
+    bool ok = true;
+    for (size_t length = 0; ok && length <= max_length; ++length) {
+        kernels[DispatchIndex<Pack>::value](input.data(), output.data(),
+                                            length, randomness);
+        for (size_t i = 0; i < length; ++i) {
+            if (output[i] != Pack::HashFunction(input[i], randomness)) {
+                std::cout << string(Pack::NAME)
+                          << " kernel disagrees with scalar at index " << i
+                          << " of " << length << std::endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+    delete randomness;
+    return ok;
+}
+
+// Checks that a dispatched pack draws the same randomness as the pack itself
+// from one seed (the kernel objects share the random stream with the
+// program), and that InitRandomness(r, seed) draws it from seed whatever
+// was drawn before, leaving the stream where it was. The randomness is
+// compared through its hashes, since some structures have padding.
+template <typename Pack>
+static bool CheckSeeded(uint64_t seed) {
+    typedef typename Dispatched<Pack>::type DispatchedPack;
+    typedef typename Pack::Word Word;
+    typedef typename Pack::Randomness Randomness;
+    Randomness *direct = new Randomness();
+    Randomness *dispatched = new Randomness();
+    Randomness *seeded = new Randomness();
+    seed64rand(seed);
+    Pack::InitRandomness(direct);
+    const uint64_t next = get64rand();
+    seed64rand(seed);
+    DispatchedPack::InitRandomness(dispatched);
+    bool ok = get64rand() == next;
+    seed64rand(seed + 1);
+    get64rand();
+    DispatchedPack::InitRandomness(seeded, seed);
+    ok = ok && get64rand() == splitmix64_mix(seed + 1 + 2 * SPLITMIX64_GAMMA);
+    const size_t n = 1024;
+    vector<Word> keys(n), a(n), b(n);
+    for (size_t i = 0; i < n; ++i) keys[i] = Word(splitmix64_mix(i));
+    DispatchedPack::HashBatch(keys.data(), a.data(), n, dispatched);
+    DispatchedPack::HashBatch(keys.data(), b.data(), n, seeded);
+    for (size_t i = 0; ok && i < n; ++i) {
+        ok = a[i] == Pack::HashFunction(keys[i], direct) && b[i] == a[i];
+    }
+    if (!ok) {
+        std::cout << string(Pack::NAME)
+                  << " does not draw its randomness from the seed"
+                  << std::endl;
+    }
+    delete direct;
+    delete dispatched;
+    delete seeded;
+    return ok;
+}
+
+int main() {
+    const size_t max_length = 67;
+    bool buggy = false;
+    const ShorthashIsa best = ShorthashBestIsa();
+    for (int level = int(ShorthashIsa::X86_64_V2); level <= int(best);
+         ++level) {
+        const ShorthashIsa isa = ShorthashIsa(level);
+        std::cout << "testing " << ShorthashIsaName(isa) << std::endl;
+        const ShorthashBatchKernel *kernels = ShorthashKernelsFor(isa);
+#define SHORTHASH_CHECK(pack, word, randomness, batch) \
+    buggy |= !Check<pack>(kernels, max_length);
+        SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_CHECK)
+#undef SHORTHASH_CHECK
+    }
+#define SHORTHASH_CHECK_SEEDED(pack, word, randomness, batch) \
+    buggy |= !CheckSeeded<pack>(42);
+    SHORTHASH_DISPATCH_FAMILIES(SHORTHASH_CHECK_SEEDED)
+#undef SHORTHASH_CHECK_SEEDED
+    if (buggy) {
+        std::cout << "Bugs found."
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "Code ok." << std::endl;
+}
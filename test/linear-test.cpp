@@ -0,0 +1,26 @@
+#include <iostream>
+
+using namespace std;
+
+extern "C" {
+#include "util.h"
+#include "linear.h"
+}
+
+// The table-driven Linear64 must agree with the parity definition.
+int main() {
+    Linear64Randomness *r = new Linear64Randomness();
+    for (int trial = 0; trial < 16; ++trial) {
+        Linear64Init(r);
+        for (int i = 0; i < 100000; ++i) {
+            const uint64_t x = get64rand();
+            if (Linear64(x, r) != Linear64Parity(x, r)) {
+                cerr << hex << "0x" << x << ": 0x" << Linear64(x, r)
+                     << " instead of 0x" << Linear64Parity(x, r) << endl;
+                delete r;
+                return 1;
+            }
+        }
+    }
+    delete r;
+}
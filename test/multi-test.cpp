@@ -0,0 +1,138 @@
+#include <iostream>
+
+using namespace std;
+
+#include "../benchmarks/tabulation.h"
+
+// The first K outputs of HashMulti<K> must not depend on K.
+template <typename Pack, int K>
+static bool CheckPrefix(typename Pack::Word x,
+                        const typename Pack::Word *all,
+                        const typename Pack::Randomness *r) {
+    typename Pack::Word out[K];
+    Pack::template HashMulti<K>(x, out, r);
+    for (int i = 0; i < K; ++i) {
+        if (out[i] != all[i]) {
+            cout << string(Pack::NAME) << " HashMulti<" << K << "> output "
+                 << i << " disagrees with HashMulti<" << Pack::OUTPUTS << ">"
+                 << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks HashMulti against a reference computing each output on its own:
+// Reference(x, i, r) is output i of x.
+template <typename Pack, typename Reference>
+static bool Check(Reference reference) {
+    typedef typename Pack::Word Word;
+    cout << "testing " << string(Pack::NAME) << endl;
+    seed64rand(0);
+    typename Pack::Randomness *r = new typename Pack::Randomness();
+    Pack::InitRandomness(r);
+    bool ok = true;
+    for (int trial = 0; trial < 10000 && ok; ++trial) {
+        const Word x = trial < 2 ? Word(0 - trial) : Word(get64rand());
+        Word all[Pack::OUTPUTS];
+        Pack::template HashMulti<Pack::OUTPUTS>(x, all, r);
+        for (int i = 0; i < Pack::OUTPUTS && ok; ++i) {
+            if (all[i] != reference(x, i, r)) {
+                cout << string(Pack::NAME) << " output " << i << " of "
+                     << uint64_t(x) << " disagrees with the reference"
+                     << endl;
+                ok = false;
+            }
+        }
+        ok = ok && CheckPrefix<Pack, 1>(x, all, r) &&
+             CheckPrefix<Pack, 2>(x, all, r) &&
+             CheckPrefix<Pack, (Pack::OUTPUTS < 3 ? 1 : 3)>(x, all, r) &&
+             CheckPrefix<Pack, (Pack::OUTPUTS + 1) / 2>(x, all, r);
+    }
+    delete r;
+    return ok;
+}
+
+template <int KEY_BITS, int CHAR_BITS, int OUTPUTS>
+static bool CheckTabulation() {
+    typedef TabulationMultiPack<KEY_BITS, CHAR_BITS, OUTPUTS> Pack;
+    typedef typename Pack::Layout Layout;
+    typedef typename Pack::Word Word;
+    return Check<Pack>([](Word x, int i, const typename Pack::Randomness *r) {
+        Word h = 0;
+        for (int j = 0; j < Layout::CHARS; ++j) {
+            const size_t c = (x >> (j * CHAR_BITS)) &
+                             ((size_t(1) << Layout::CHARACTER_BITS) - 1);
+            h ^= r->hashtab[j * Layout::TABLE_SIZE + c][i];
+        }
+        return h;
+    });
+}
+
+int main() {
+    bool ok = true;
+    ok = Check<UnivMultiplyShiftMulti64Pack>(
+             [](uint64_t x, int i,
+                const UnivMultiplyShiftMulti64Pack::Randomness *r) {
+                 return UnivMultiplyShift64Pack::HashFunction(
+                     x, &r->instances[i]);
+             }) &&
+         ok;
+    ok = Check<ClLinearMulti64Pack>(
+             [](uint64_t x, int i, const cl_linear_multi_t *r) {
+                 cl_linear_t one;
+                 one.multiplier = _mm_cvtsi64_si128(r->multiplier[i]);
+                 one.constant = _mm_cvtsi64_si128(r->constant[i]);
+                 return cl_linear(x, &one);
+             }) &&
+         ok;
+    // output 2 i is cl_linear32 itself, output 2 i + 1 the other half of
+    // its joint pair
+    ok = Check<ClLinearMulti32Pack>(
+             [](uint32_t x, int i, const cl_linear_multi_t *r) {
+                 cl_linear_t one;
+                 one.multiplier = _mm_cvtsi64_si128(r->multiplier[i / 2]);
+                 one.constant = _mm_cvtsi64_si128(r->constant[i / 2]);
+                 return i % 2 == 0 ? cl_linear32(x, &one)
+                                   : uint32_t(cl_linear(x, &one) >> 32);
+             }) &&
+         ok;
+    ok = Check<ClFastQuadraticMulti64Pack>(
+             [](uint64_t x, int i, const cl_fastquadratic_multi_t *r) {
+                 cl_fastquadratic_t one;
+                 one.multiplier = _mm_set_epi64x(r->squaremultiplier[i],
+                                                 r->multiplier[i]);
+                 one.shiftmultiplier = _mm_cvtsi64_si128(r->shiftmultiplier[i]);
+                 one.constant = _mm_cvtsi64_si128(r->constant[i]);
+                 return cl_fastquadratic(x, &one);
+             }) &&
+         ok;
+    // output 2 i is cl_fastquadratic32 itself, output 2 i + 1 the other half
+    // of its joint pair
+    ok = Check<ClFastQuadraticMulti32Pack>(
+             [](uint32_t x, int i, const cl_fastquadratic_multi_t *r) {
+                 cl_fastquadratic32_t one;
+                 one.multiplier = _mm_set_epi64x(r->squaremultiplier[i / 2],
+                                                 r->multiplier[i / 2]);
+                 one.constant = _mm_cvtsi64_si128(r->constant[i / 2]);
+                 if (i % 2 == 0) return cl_fastquadratic32(x, &one);
+                 cl_fastquadratic_t wide;
+                 wide.multiplier = one.multiplier;
+                 wide.shiftmultiplier = _mm_setzero_si128();
+                 wide.constant = one.constant;
+                 return uint32_t(cl_fastquadratic(x, &wide) >> 32);
+             }) &&
+         ok;
+    ok = CheckTabulation<64, 8, 2>() && ok;
+    ok = CheckTabulation<64, 8, 4>() && ok;
+    ok = CheckTabulation<64, 16, 8>() && ok;
+    ok = CheckTabulation<64, 11, 3>() && ok;
+    ok = CheckTabulation<32, 8, 8>() && ok;
+    ok = CheckTabulation<32, 16, 4>() && ok;
+    if (!ok) {
+        cout << "Bugs found." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "Code ok." << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/hashpack.h"
+
+static const char *PATH = "randomness-file-test.bin";
+
+// A hasher built over the mapped randomness must hash like the original,
+// and share the mapping when the pack keeps its tables out of line.
+template <typename Pack>
+static bool CheckAdopted(
+    const Pack &pack,
+    const std::shared_ptr<const typename Pack::Randomness> &mapped,
+    std::true_type) {
+    typedef typename Pack::Word Word;
+    const Pack adopted(mapped);
+    if (sizeof(typename Pack::Randomness) > 64 &&
+        adopted.GetRandomness() != mapped.get()) {
+        std::cout << string(Pack::NAME) << " copied the mapped randomness"
+                  << std::endl;
+        return false;
+    }
+    for (int i = 0; i < 1000; ++i) {
+        const Word x = get64rand();
+        if (adopted(x) != pack(x)) {
+            std::cout << string(Pack::NAME)
+                      << " hasher over the mapping hashes differently"
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Pack>
+static bool CheckAdopted(
+    const Pack &, const std::shared_ptr<const typename Pack::Randomness> &,
+    std::false_type) {
+    return true;
+}
+
+// Saved then mapped randomness must hash like the original, and files must
+// be rejected by other packs.
+struct Worker {
+    template <typename Pack>
+    static inline void Go(bool *buggy) {
+        typedef typename Pack::Word Word;
+        std::cout << "testing " << string(Pack::NAME) << std::endl;
+        const Pack pack;
+        if (!SaveRandomness<Pack>(PATH, pack.GetRandomness())) {
+            std::cout << "cannot write " << PATH << std::endl;
+            *buggy = true;
+            return;
+        }
+        const auto mapped = MapRandomness<Pack>(PATH);
+        if (mapped == NULL) {
+            std::cout << string(Pack::NAME) << " cannot map its own file"
+                      << std::endl;
+            *buggy = true;
+            return;
+        }
+        for (int i = 0; i < 1000; ++i) {
+            const Word x = get64rand();
+            if (Pack::HashFunction(x, mapped.get()) !=
+                Pack::HashFunction(x, pack.GetRandomness())) {
+                std::cout << string(Pack::NAME)
+                          << " mapped randomness hashes differently"
+                          << std::endl;
+                *buggy = true;
+                return;
+            }
+        }
+        typedef std::shared_ptr<const typename Pack::Randomness> Mapped;
+        if (!CheckAdopted(pack, mapped,
+                          std::is_constructible<Pack, Mapped>())) {
+            *buggy = true;
+            return;
+        }
+        if (MapRandomness<Identity64Pack>(PATH) != NULL) {
+            std::cout << string(Pack::NAME) << " file accepted by Identity64"
+                      << std::endl;
+            *buggy = true;
+        }
+    }
+    static inline void Stop() {}
+};
+
+int main() {
+    bool buggy = false;
+    ForEachT<Zobrist64Pack, WZobrist64Pack, ThorupZhang64Pack, Linear64Pack,
+             MixedTab64Pack<4>,
+             ClQuadratic64Pack, ThorupZhangCWCubic64Pack, SipPack,
+             SplitPack<MultiplyShift64Pack, MultiplyShift64Pack, 64>,
+             WZobrist32Pack, ThorupZhang32Pack>::template Go<Worker>(&buggy);
+    remove(PATH);
+    if (buggy) {
+        std::cout << "Randomness files are broken." << std::endl;
+        return 1;
+    }
+    std::cout << "Code ok." << std::endl;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/hashpack.h"
+
+// Checks that HashRange agrees with HashFunction on the keys start + i stride,
+// for every length up to MAX_LENGTH and for ranges that wrap around.
+struct Worker {
+    template <typename Pack>
+    static inline void Go(const size_t max_length, bool *buggy) {
+        typedef typename Pack::Word Word;
+        std::cout << "testing " << string(Pack::NAME) << std::endl;
+        seed64rand(0);
+        typename Pack::Randomness *randomness = new typename Pack::Randomness();
+        Pack::InitRandomness(randomness);
+        const Word top = ~Word(0);
+        const Word starts[] = {0, 1, Word(get64rand()), Word(top - 40),
+                               Word(top / 2 + 1)};
+        const Word strides[] = {0,     1,          2,
+                                3,     Word(1) << 16, Word(1) << 31,
+                                Word(get64rand()), Word(top / 3),
+                                Word(top - 1)};
+        vector<Word> output(max_length);
+        for (Word start : starts) {
+            for (Word stride : strides) {
+                for (size_t length = 0; length <= max_length; ++length) {
+                    Pack::HashRange(start, stride, length, output.data(),
+                                    randomness);
+                    Word x = start;
+                    for (size_t i = 0; i < length; ++i, x += stride) {
+                        if (output[i] != Pack::HashFunction(x, randomness)) {
+                            std::cout << string(Pack::NAME)
+                                      << " range disagrees with scalar at "
+                                      << "index " << i << " of " << length
+                                      << " (start " << uint64_t(start)
+                                      << ", stride " << uint64_t(stride)
+                                      << ")" << std::endl;
+                            *buggy = true;
+                            delete randomness;
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+        delete randomness;
+    }
+    static inline void Stop() {}
+};
+
+int main() {
+    const size_t max_length = 300;
+    bool buggy = false;
+    ForEachT<MultiplyShift64Pack, UnivMultiplyShift64Pack,
+             ThorupZhangCWLinear64Pack, ThorupZhangCWQuadratic64Pack,
+             ThorupZhangCWCubic64Pack, FasterCWLinear64Pack,
+             FasterCWQuadratic64Pack, FasterCWCubic64Pack, Zobrist64Pack,
+             MultiplyShift32Pack, ThorupZhangCWLinear32Pack,
+             ThorupZhangCWQuadratic32Pack, ThorupZhangCWCubic32Pack,
+             Zobrist32Pack>::template Go<Worker>(max_length, &buggy);
+    if (buggy) {
+        std::cout << "Range hashing does not match scalar hashing."
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "Code ok." << std::endl;
+}
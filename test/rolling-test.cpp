@@ -0,0 +1,122 @@
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "rolling.h"
+#include "tabulated.h"
+
+static uint64_t Rotr(uint64_t x, size_t r) {
+    r %= 64;
+    return r == 0 ? x : (x >> r) | (x << (64 - r));
+}
+
+// a b in GF(2)[x] / (x^64 + x^4 + x^3 + x + 1), one bit at a time
+static uint64_t GFMultiply(uint64_t a, uint64_t b) {
+    uint64_t p = 0;
+    for (int i = 0; i < 64; ++i) {
+        if ((b >> i) & 1) p ^= a;
+        a = (a << 1) ^ ((0 - (a >> 63)) & UINT64_C(0x1B));
+    }
+    return p;
+}
+
+// The definition, from hashtab alone: CYCLIC is the xor of T[s_j] rotated
+// right by j, GENERAL the sum of x^(n-1-j) T[s_j]. power[j] is x^j.
+static uint64_t Reference(const unsigned char *s, const rolling_t *k,
+                          const vector<uint64_t> &power) {
+    uint64_t h = 0;
+    for (size_t j = 0; j < k->n; ++j) {
+        h ^= k->general ? GFMultiply(power[k->n - 1 - j], k->hashtab[s[j]])
+                        : Rotr(k->hashtab[s[j]], j);
+    }
+    return h;
+}
+
+// Checks rolling_hash against rolling_window on every window, for short and
+// long buffers (one run or four runs side by side), rolling_hash_lanes
+// against rolling_hash, every 61st window and the last one against the
+// definition, and CYCLIC with n = 8 against cyclic.
+static bool Check(bool general, size_t n) {
+    rolling_t *k = new rolling_t();
+    seed64rand(n);
+    if (general) {
+        rolling_general_init(k, n);
+    } else {
+        rolling_cyclic_init(k, n);
+    }
+    vector<uint64_t> power(n, 1);
+    for (size_t j = 1; j < n; ++j) power[j] = GFMultiply(power[j - 1], 2);
+    const size_t lengths[] = {0, n - 1, n, n + 1, n + 7, 100, 8 * 64 + n - 1,
+                              8 * (n + 64) + n + 13, 4 * (n + 64) + n + 5,
+                              8 * 65 + n - 1, 8 * (64 * 3 + 1) + n + 6, 20000};
+    bool ok = true;
+    for (size_t len : lengths) {
+        if (len < n && len != 0 && len != n - 1) continue;
+        vector<unsigned char> s(len);
+        for (size_t i = 0; i < len; ++i) s[i] = (unsigned char)get64rand();
+        // a long run of one byte, where the rotations of CYCLIC line up
+        for (size_t i = len / 2; i < len / 2 + len / 8; ++i) s[i] = 'a';
+        const size_t windows = len >= n ? len - n + 1 : 0;
+        vector<uint64_t> out(windows + 1, 0);
+        rolling_hash(s.data(), len, out.data(), k);
+        for (size_t i = 0; i < windows; ++i) {
+            if (out[i] != rolling_window(s.data() + i, k)) {
+                cout << (general ? "general" : "cyclic") << " n = " << n
+                     << ": window " << i << " of " << windows
+                     << " disagrees with the direct hash" << endl;
+                ok = false;
+                break;
+            }
+        }
+        vector<uint64_t> lanes(windows + 1, 0);
+        rolling_hash_lanes(s.data(), len, lanes.data(), k);
+        if (lanes != out) {
+            cout << (general ? "general" : "cyclic") << " n = " << n
+                 << ": rolling_hash_lanes disagrees with rolling_hash" << endl;
+            ok = false;
+        }
+        for (size_t i = 0; i < windows; ++i) {
+            if (i % 61 != 0 && i + 1 != windows) continue;
+            if (out[i] != Reference(s.data() + i, k, power)) {
+                cout << (general ? "general" : "cyclic") << " n = " << n
+                     << ": window " << i << " of " << windows
+                     << " disagrees with the definition" << endl;
+                ok = false;
+                break;
+            }
+        }
+        if (!general && n == 8) {
+            cyclic_t *c = new cyclic_t();
+            for (int b = 0; b < 256; ++b) c->hashtab[b] = k->hashtab[b];
+            for (size_t i = 0; i < windows; ++i) {
+                uint64_t word;
+                memcpy(&word, s.data() + i, sizeof(word));
+                if (out[i] != cyclic(word, c)) {
+                    cout << "cyclic n = 8: window " << i
+                         << " disagrees with cyclic()" << endl;
+                    ok = false;
+                    break;
+                }
+            }
+            delete c;
+        }
+    }
+    delete k;
+    return ok;
+}
+
+int main() {
+    const size_t ns[] = {1, 2, 3, 7, 8, 9, 16, 48, 63, 64, 65, 100, 257};
+    bool ok = true;
+    for (size_t n : ns) {
+        ok &= Check(false, n);
+        ok &= Check(true, n);
+    }
+    if (!ok) {
+        cout << "Rolling hashing does not match direct hashing." << endl;
+        return 1;
+    }
+    cout << "Code ok." << endl;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+
+using namespace std;
+
+#include "../benchmarks/tabulation.h"
+
+// With 8- and 16-bit characters, Tabulation must be the hand-written zobrist
+// variants: same tables from the same seed, same hash values.
+template <typename Pack, typename Randomness, void (*Init)(Randomness *),
+          typename Pack::Word (*Hash)(typename Pack::Word, const Randomness *)>
+static bool Check(const char *name) {
+    typename Pack::Randomness *r = new typename Pack::Randomness();
+    Randomness *expected = new Randomness();
+    bool ok = sizeof(*r) == sizeof(*expected);
+    for (uint64_t seed = 1; ok && seed <= 4; ++seed) {
+        seed64rand(seed);
+        Pack::InitRandomness(r);
+        seed64rand(seed);
+        Init(expected);
+        for (int i = 0; ok && i < 100000; ++i) {
+            const typename Pack::Word x = get64rand();
+            if (Pack::HashFunction(x, r) != Hash(x, expected)) {
+                cerr << Pack::NAME << " differs from " << name << " on 0x"
+                     << hex << uint64_t(x) << dec << endl;
+                ok = false;
+            }
+        }
+    }
+    delete expected;
+    delete r;
+    return ok;
+}
+
+int main() {
+    bool ok = Check<TabulationPack<64, 8, 64>, zobrist_t, zobrist_init,
+                    zobrist>("zobrist");
+    ok &= Check<TabulationPack<64, 16, 64>, wzobrist_t, wzobrist_init,
+                wzobrist>("wzobrist");
+    ok &= Check<TabulationPack<32, 8, 32>, zobrist32_t, zobrist32_init,
+                zobrist32>("zobrist32");
+    ok &= Check<TabulationPack<32, 16, 32>, wzobrist32_t, wzobrist32_init,
+                wzobrist32>("wzobrist32");
+    if (!ok) return 1;
+    cout << "Code ok." << endl;
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+
+using namespace std;
+
+#include "tabulated.h"
+
+// Keys differing in d of their 8 input characters must differ in at least
+// 8 - d of the 7 derived characters of the compact Thorup-Zhang hash.
+int main() {
+    thorupzhang_compact_t *k = new thorupzhang_compact_t();
+    thorupzhang_compact_init(k);
+    bool ok = true;
+    for (int i = 0; ok && i < 1000000; ++i) {
+        const uint64_t x = get64rand();
+        uint64_t y = x;
+        const int d = 1 + i % 8;
+        for (int changed = 0; changed < d;) {
+            const int c = get64rand() % 8;
+            if (((x ^ y) >> (8 * c)) & 0xFF) continue;
+            y ^= (1 + get64rand() % 255) << (8 * c);
+            ++changed;
+        }
+        uint64_t hx, hy;
+        uint16_t cx[8], cy[8];
+        _mm_storeu_si128((__m128i *)cx, thorupzhang_compact_base(x, k, &hx));
+        _mm_storeu_si128((__m128i *)cy, thorupzhang_compact_base(y, k, &hy));
+        int distance = d;
+        for (int j = 0; j < THORUPZHANG_COMPACT_DERIVED; ++j) {
+            if (cx[j] >= THORUPZHANG_COMPACT_DERIVED_SIZE) ok = false;
+            distance += cx[j] != cy[j];
+        }
+        if (distance < 8) {
+            cerr << "0x" << hex << x << " and 0x" << y << dec
+                 << " differ in only " << distance << " characters" << endl;
+            ok = false;
+        }
+    }
+    delete k;
+    if (!ok) return 1;
+    cout << "Code ok." << endl;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+
+using namespace std;
+
+#include "../benchmarks/hashpack.h"
+
+// a b in GF(2)[x] / (x^64 + x^4 + x^3 + x + 1), one bit at a time
+static uint64_t GFMultiply(uint64_t a, uint64_t b) {
+    uint64_t p = 0;
+    for (int i = 0; i < 64; ++i) {
+        if ((b >> i) & 1) p ^= a;
+        a = (a << 1) ^ ((0 - (a >> 63)) & UINT64_C(0x1B));
+    }
+    return p;
+}
+
+static uint64_t Low(__m128i x) { return (uint64_t)_mm_cvtsi128_si64(x); }
+
+static uint64_t High(__m128i x) {
+    return (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(x, x));
+}
+
+// a 128-bit word as two 64-bit limbs, for a reference that does not rely on
+// uint128_t arithmetic
+struct Limbs {
+    uint64_t lo, hi;
+};
+
+static Limbs Split(uint128_t x) {
+    Limbs l;
+    l.lo = (uint64_t)x;
+    l.hi = (uint64_t)(x >> 64);
+    return l;
+}
+
+// a + b modulo 2^128
+static Limbs Add(Limbs a, Limbs b) {
+    Limbs s;
+    s.lo = a.lo + b.lo;
+    s.hi = a.hi + b.hi + (s.lo < a.lo);
+    return s;
+}
+
+// a b modulo 2^128: the low limbs multiplied from 32-bit halves, plus the
+// cross products, which only reach the high limb
+static Limbs Multiply(Limbs a, Limbs b) {
+    const uint64_t a0 = a.lo & 0xFFFFFFFF, a1 = a.lo >> 32;
+    const uint64_t b0 = b.lo & 0xFFFFFFFF, b1 = b.lo >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t middle =
+        (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    Limbs p;
+    p.lo = (middle << 32) | (p00 & 0xFFFFFFFF);
+    p.hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32) + a.lo * b.hi +
+           a.hi * b.lo;
+    return p;
+}
+
+// ((a0 + x1) (a1 + x0) + b) >> 64 with x = x1 2^64 + x0, on the limbs
+static uint64_t PairMultiplyShift(uint64_t x0, uint64_t x1,
+                                  const PairMultiplyShift128Randomness *r) {
+    const Limbs left = Add(Split(r->mult[0]), Split(x1));
+    const Limbs right = Add(Split(r->mult[1]), Split(x0));
+    return Add(Multiply(left, right), Split(r->add)).hi;
+}
+
+// Checks the 128-bit CL families against a bitwise reference on the two
+// limbs, PairMultiplyShift128 against limb arithmetic, zobrist128 against its
+// table rows, and that every 128-bit pack
+// leaves the high half of its hashes zero.
+struct Worker {
+    template <typename Pack>
+    static inline void Go(bool *buggy) {
+        typedef typename Pack::Word Word;
+        seed64rand(1);
+        typename Pack::Randomness *r = new typename Pack::Randomness();
+        Pack::InitRandomness(r);
+        for (int trial = 0; trial < 1000; ++trial) {
+            if ((Pack::HashFunction(Word(get128rand()), r) >> 64) != 0) {
+                cout << string(Pack::NAME) << " hash is wider than 64 bits"
+                     << endl;
+                *buggy = true;
+                break;
+            }
+        }
+        delete r;
+    }
+    static inline void Stop() {}
+};
+
+int main() {
+    bool buggy = false;
+    seed64rand(0);
+    cl_linear128_t *lin = new cl_linear128_t();
+    cl_quadratic128_t *quad = new cl_quadratic128_t();
+    zobrist128_t *zob = new zobrist128_t();
+    PairMultiplyShift128Randomness *pms = new PairMultiplyShift128Randomness();
+    cl_linear128_init(lin);
+    cl_quadratic128_init(quad);
+    zobrist128_init(zob);
+    PairMultiplyShift128Init(pms);
+    for (int trial = 0; trial < 10000; ++trial) {
+        uint128_t x = get128rand();
+        if (trial < 64) x = uint128_t(1) << (2 * trial);
+        if (trial == 64) x = ~uint128_t(0);
+        const uint64_t x0 = (uint64_t)x, x1 = (uint64_t)(x >> 64);
+        const uint64_t linear = GFMultiply(Low(lin->multiplier), x0) ^
+                                GFMultiply(High(lin->multiplier), x1) ^
+                                Low(lin->constant);
+        if (cl_linear128(x, lin) != linear) {
+            cout << "cl_linear128 disagrees with the reference" << endl;
+            buggy = true;
+            break;
+        }
+        const uint64_t quadratic =
+            GFMultiply(Low(quad->squaremultiplier), GFMultiply(x0, x0)) ^
+            GFMultiply(High(quad->squaremultiplier), GFMultiply(x1, x1)) ^
+            GFMultiply(Low(quad->multiplier), x0) ^
+            GFMultiply(High(quad->multiplier), x1) ^ Low(quad->constant);
+        if (cl_quadratic128(x, quad) != quadratic) {
+            cout << "cl_quadratic128 disagrees with the reference" << endl;
+            buggy = true;
+            break;
+        }
+        if (PairMultiplyShift128(x, pms) != PairMultiplyShift(x0, x1, pms)) {
+            cout << "PairMultiplyShift128 disagrees with the reference" << endl;
+            buggy = true;
+            break;
+        }
+        uint64_t tabulated = 0;
+        for (int j = 0; j < 16; ++j) {
+            tabulated ^= zob->hashtab[j][(x >> (8 * j)) & 0xFF];
+        }
+        if (zobrist128(x, zob) != tabulated) {
+            cout << "zobrist128 disagrees with the reference" << endl;
+            buggy = true;
+            break;
+        }
+    }
+    delete lin;
+    delete quad;
+    delete zob;
+    delete pms;
+    ForEachT<ClLinear128Pack, ClQuadratic128Pack, PairMultiplyShift128Pack,
+             Zobrist128Pack, Sip128Pack>::template Go<Worker>(&buggy);
+    if (buggy) {
+        cout << "Bugs found." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "Code ok." << endl;
+    return EXIT_SUCCESS;
+}
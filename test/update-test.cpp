@@ -0,0 +1,84 @@
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+#include "../benchmarks/hashpack.h"
+
+// Checks that Update agrees with HashFunction on the new key, for keys that
+// differ in one bit, one character or all of them, and that HashGrayCode
+// agrees with HashFunction on the Gray codes, including across the wrap.
+struct Worker {
+    template <typename Pack>
+    static inline void Go(const size_t max_length, bool *buggy) {
+        typedef typename Pack::Word Word;
+        std::cout << "testing " << string(Pack::NAME) << std::endl;
+        seed64rand(0);
+        typename Pack::Randomness *randomness = new typename Pack::Randomness();
+        Pack::InitRandomness(randomness);
+        for (int trial = 0; trial < 10000; ++trial) {
+            const Word old_key = Word(get64rand());
+            Word new_key;
+            switch (trial % 3) {
+                case 0:
+                    new_key = old_key ^ (Word(1) << (get64rand() % 64));
+                    break;
+                case 1:
+                    new_key = old_key ^ (Word(get64rand() & 0xFF)
+                                         << (8 * (get64rand() % 8)));
+                    break;
+                default:
+                    new_key = Word(get64rand());
+            }
+            const Word h = Pack::Update(Pack::HashFunction(old_key, randomness),
+                                        old_key, new_key, randomness);
+            if (h != Pack::HashFunction(new_key, randomness)) {
+                std::cout << string(Pack::NAME) << " update disagrees with "
+                          << "scalar from " << uint64_t(old_key) << " to "
+                          << uint64_t(new_key) << std::endl;
+                *buggy = true;
+                delete randomness;
+                return;
+            }
+        }
+        const Word top = ~Word(0);
+        const Word firsts[] = {0, 1, Word(get64rand()), Word(top - 40),
+                               Word(top / 2 - 100)};
+        vector<Word> output(max_length);
+        for (Word first : firsts) {
+            for (size_t length = 0; length <= max_length; ++length) {
+                Pack::HashGrayCode(first, length, output.data(), randomness);
+                for (size_t i = 0; i < length; ++i) {
+                    const Word g = first + Word(i);
+                    if (output[i] !=
+                        Pack::HashFunction(g ^ (g >> 1), randomness)) {
+                        std::cout << string(Pack::NAME)
+                                  << " Gray code disagrees with scalar at "
+                                  << "index " << i << " of " << length
+                                  << " (first " << uint64_t(first) << ")"
+                                  << std::endl;
+                        *buggy = true;
+                        delete randomness;
+                        return;
+                    }
+                }
+            }
+        }
+        delete randomness;
+    }
+    static inline void Stop() {}
+};
+
+int main() {
+    const size_t max_length = 300;
+    bool buggy = false;
+    ForEachT<Cyclic64Pack, Zobrist64Pack, WZobrist64Pack, ClLinear64Pack,
+             Linear64Pack, Toeplitz64Pack>::template Go<Worker>(max_length,
+                                                                &buggy);
+    if (buggy) {
+        std::cout << "Incremental hashing does not match scalar hashing."
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "Code ok." << std::endl;
+}
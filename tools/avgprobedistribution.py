@@ -6,35 +6,21 @@ import subprocess
 import io
 import os
 
+from hashfamilies import hashfamilyindex
+
 # model 0 is geometric
 # model 1 is fromtop
 # model 2 is random
 # model 3 is graycode
-# hashfamily 0 is murmur
-# hashfamily 1 is koloboke
-# hashfamily 2 is zobrist
-# hashfamily 3 is wide-zobrist
-# hashfamily 4 is tztabulated
-# hashfamily 5 is cllinear
-# hashfamily 6 is clquadratic
-# hashfamily 7 is clcubic
-# hashfamily 8 is cwlinear
-# hashfamily 9 is cwquadratic
-# hashfamily 10 is cwcubic
-# hashfamily 11 is multiplyshift
-# hashfamily 12 is cyclic
-# hashfamily 13 is fnv
-# hashfamily 14 is identity
-# hashfamily 15 is oddmultiply
-# hashfamily 16 is randkolokobe
+# the hash families are those of ./param_htbenchmark.exe -h (see hashfamilies.py)
 
 allmodels = ["geometric", "fromtop", "random", "graycode"]
-allfamilies = ["murmur", "koloboke", "zobrist", "wide-zobrist", "tztabulated", "cllinear", "clquadratic", "clcubic", "cwlinear",  "cwquadratic", "cwcubic", "multiplyshift", "cyclic" , "fnv", "identity", "oddmultiply", "randkolokobe"]
+allfamilies = ["murmur", "koloboke", "zobrist", "wide-zobrist", "tztabulated", "cllinear", "clquadratic", "clcubic", "cwlinear",  "cwquadratic", "cwcubic", "multiplyshift", "cyclic" , "fnv", "identity", "reversedoddmultiply", "randomkoloboke", "twisted", "doubletab", "compacttz"]
 scriptlocation = os.path.dirname(os.path.abspath(__file__))
 
-#Usage: ./param_htbenchmark.exe -l [maxloadfactor:0-1] -s [size:>0] -m [model:0-3] -H [hashfamily:0-11]
+#Usage: ./param_htbenchmark.exe -l [maxloadfactor:0-1] -s [size:>0] -m [model:0-3] -H [hashfamily:0-20]
 def getavgprobe(size, model, family):
-  pipe = subprocess.Popen([scriptlocation+"/../"+"param_htbenchmark.exe", "-l", "1", "-s" , str(size),  "-m", str(model), "-H", str(family)], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+  pipe = subprocess.Popen([scriptlocation+"/../"+"param_htbenchmark.exe", "-l", "1", "-s" , str(size),  "-m", str(model), "-H", str(hashfamilyindex(allfamilies[family]))], stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
   res = pipe.communicate()[0].decode().split("\n")
   res = tuple(filter(lambda x: len(x)>0,res))
   res = tuple(filter(lambda x: not(x.startswith("#")),res))
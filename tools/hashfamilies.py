@@ -0,0 +1,36 @@
+########################################################################
+# The hash families of param_htbenchmark.exe, read from its usage output
+# so that the scripts in this directory never go out of sync with its -H
+# indexes.
+########################################################################
+import os
+import re
+import subprocess
+
+scriptlocation = os.path.dirname(os.path.abspath(__file__))
+param_htbenchmark = scriptlocation + "/../param_htbenchmark.exe"
+
+def hashfamilies():
+  out = subprocess.run([param_htbenchmark, "-h"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT).stdout.decode()
+  families = {}
+  for line in out.split("\n"):
+    m = re.match(r"hashfamily (\d+) is (\S+)", line)
+    if m:
+      families[m.group(2)] = int(m.group(1))
+  return families
+
+_families = None
+
+# the -H index of the family with the given name
+def hashfamilyindex(name):
+  global _families
+  if _families is None:
+    _families = hashfamilies()
+  return _families[name]
+
+# the names of all the families, in -H order
+def hashfamilynames():
+  global _families
+  if _families is None:
+    _families = hashfamilies()
+  return sorted(_families, key=_families.get)